@@ -0,0 +1,111 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "hostprof.h"
+
+// Binary pipeline tracer.
+// Fixed-size records are pushed into a single-producer ring buffer owned by
+// the core and drained to disk by a background writer thread. The file
+// starts with a TraceFileHeader followed by packed TraceRecords; it is
+// rendered as text by Tools/src/tracedump.cpp.
+
+namespace tinyrv {
+
+#define TRACE_MAGIC   0x54565254 // "TRVT"
+#define TRACE_VERSION 1
+
+enum class TraceStage : uint8_t {
+  Fetch,
+  Decode,
+  Issue,
+  Execute,
+  Memory,
+  Writeback,
+  Commit
+};
+
+enum class TraceEvent : uint8_t {
+  Stage,    // instruction processed by stage, payload=stage data
+  Stall,    // stage stalled, aux=stall reason
+  Flush,    // pipeline flush, payload=new PC
+  Branch,   // branch resolved, payload=target, aux=taken|(mispredict<<1)
+  MemRead,  // payload=addr|(data<<32), aux=size
+  MemWrite, // payload=addr|(data<<32), aux=size
+  RSState,  // reservation station entry, aux=index, payload=packed entry
+  ROBState  // reorder buffer entry, aux=index, payload=packed entry
+};
+
+struct TraceFileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t core_id;
+};
+
+struct TraceRecord {
+  uint64_t   cycle;
+  uint64_t   uuid;
+  uint32_t   PC;
+  TraceStage stage;
+  TraceEvent event;
+  uint16_t   aux;
+  uint64_t   payload;
+};
+
+static_assert(sizeof(TraceRecord) == 32, "trace records must stay 32 bytes");
+
+class TraceWriter {
+public:
+  TraceWriter(const char* filename, uint32_t core_id, uint32_t capacity = (1 << 16));
+
+  ~TraceWriter();
+
+  void push(const TraceRecord& record) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    // wait for the writer thread if the ring is full
+    while (tail - head_.load(std::memory_order_acquire) == ring_.size()) {
+      std::this_thread::yield();
+    }
+    ring_[tail & mask_] = record;
+    tail_.store(tail + 1, std::memory_order_release);
+  }
+
+private:
+
+  void drain();
+
+  std::vector<TraceRecord> ring_;
+  uint64_t mask_;
+  std::atomic<uint64_t> head_;
+  std::atomic<uint64_t> tail_;
+  std::atomic<bool> stop_;
+  FILE* file_;
+  std::thread thread_;
+};
+
+}
+
+#define BT(tracer, cycle, stage, event, uuid, PC, aux, payload) \
+  do { \
+    if (tracer) { \
+      HostScope __bt_scope(HostPhase::Trace); \
+      (tracer)->push({(cycle), (uuid), (uint32_t)(PC), TraceStage::stage, TraceEvent::event, (uint16_t)(aux), (uint64_t)(payload)}); \
+    } \
+  } while (0)
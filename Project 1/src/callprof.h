@@ -0,0 +1,71 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+namespace tinyrv {
+
+class Instr;
+
+// Guest function profiler driven by a shadow call stack.
+// JAL/JALR with rd=ra is a call, JALR x0, ra is a return; the callee is
+// identified by the PC of the instruction committed after the call.
+// Cycles and instructions are charged to the full call path, and written
+// as folded stacks (one "f0;f1;f2 <cycles>" line per path) on destruction.
+class CallProfiler {
+public:
+  CallProfiler(const char* filename, const char* symfile);
+
+  ~CallProfiler();
+
+  // charges the current cycle to the call path, after this cycle's commits
+  void tick() {
+    ++nodes_[cur_node_].cycles;
+  }
+
+  void commit(uint32_t PC, const Instr& instr);
+
+  // inclusive and exclusive cost per function
+  void print_summary(std::ostream& os) const;
+
+private:
+
+  struct node_t {
+    uint32_t func;
+    int      parent;
+    uint64_t cycles;
+    uint64_t instrs;
+    std::map<uint32_t, int> children;
+  };
+
+  void load_symbols(const char* symfile);
+
+  std::string symbol(uint32_t addr) const;
+
+  std::string path(int node) const;
+
+  std::string filename_;
+  std::map<uint32_t, std::string> symbols_;
+  std::vector<node_t> nodes_;
+  int  cur_node_;
+  bool call_pending_;
+  bool started_;
+};
+
+}
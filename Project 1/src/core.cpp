@@ -12,6 +12,7 @@
 // limitations under the License.
 
 #include <iostream>
+#include <algorithm>
 #include <iomanip>
 #include <string.h>
 #include <assert.h>
@@ -23,11 +24,24 @@
 
 using namespace tinyrv;
 
+static const char* stall_cause_names[] = {"none", "fill", "load_use", "csr", "branch", "exit"};
+
+static const char* hpm_event_names[] = {"none", "bpred_miss", "load_use", "rob_full", "rs_full", "lsu_ops", "cdb_conflict", "flush"};
+
 Core::Core(const SimContext& ctx, uint32_t core_id, ProcessorImpl* processor)
     : SimObject(ctx, "core")
     , core_id_(core_id)
     , processor_(processor)
     , reg_file_(NUM_REGS)
+    , observer_(nullptr)
+    , tracer_(nullptr)
+    , konata_(nullptr)
+    , pc_profile_(nullptr)
+    , call_profile_(nullptr)
+    , interval_(nullptr)
+    , stat_page_(nullptr)
+    , mem_profile_(nullptr)
+    , pattern_profile_(nullptr)
 {
   this->reset();
 }
@@ -39,31 +53,69 @@ void Core::reset() {
   id_ex_.reset();
   ex_mem_.reset();
   mem_wb_.reset();
+  cout_buf_.str("");
   cout_buf_.clear();
 
   PC_ = STARTUP_ADDR;
 
+  std::fill(reg_file_.begin(), reg_file_.end(), 0);
+
   uuid_ctr_ = 0;
 
   fetched_instrs_ = 0;
   perf_stats_ = PerfStats();
+  interval_base_ = PerfStats();
+  regions_.clear();
+  region_.clear();
+  region_name_.clear();
+  region_id_ = 0;
+  hpm_events_.fill(0);
+  mhpmevent_.fill(VX_HPM_EVENT_NONE);
+  mhpmcounter_base_.fill(0);
+  stall_cause_ = StallCause::Fill;
+  issue_slots_.fill(StallCause::Fill);
 
   fetch_stalled_ = false;
   exited_ = false;
 }
 
 void Core::tick() {
+  HostScope host_scope(HostPhase::Core);
   //REMOVE
   // std::cout << "TICK: Cycle" << perf_stats_.cycles 
   //             << " | Instructions executed: " << perf_stats_.instrs 
   //             << " | Stalled: " << fetch_stalled_ << std::endl;
-  this->wb_stage();
-  this->mem_stage();
-  this->ex_stage();
-  this->id_stage();
-  this->if_stage();
+  auto instrs = perf_stats_.instrs;
+  stall_cause_ = StallCause::Fill;
+
+  HOST_PROFILE(WB, this->wb_stage());
+  if (pc_profile_ && perf_stats_.instrs == instrs) {
+    pc_profile_->stall(this->oldest_PC());
+  }
+  HOST_PROFILE(MEM, this->mem_stage());
+  HOST_PROFILE(EX, this->ex_stage());
+  HOST_PROFILE(ID, this->id_stage());
+  HOST_PROFILE(IF, this->if_stage());
+
+  this->update_cpi_stack(perf_stats_.instrs != instrs);
+
+  if (call_profile_) {
+    HOST_PROFILE(Trace, call_profile_->tick());
+  }
 
   ++perf_stats_.cycles;
+
+  // periodic snapshot, plus a final partial one at exit
+  if (interval_
+   && (interval_->due(perf_stats_.cycles - interval_base_.cycles, perf_stats_.instrs - interval_base_.instrs)
+    || (exited_ && perf_stats_.instrs != interval_base_.instrs))) {
+    HOST_PROFILE(Trace, this->write_interval());
+  }
+
+  // live statistics, plus a final update at exit
+  if (stat_page_ && (stat_page_->due(perf_stats_.cycles) || exited_)) {
+    HOST_PROFILE(Trace, this->write_stat_page());
+  }
   DPN(2, std::flush);
 }
 
@@ -76,9 +128,15 @@ void Core::if_stage() {
 
   // fetch next instruction from memory at PC address
   uint32_t instr_code = 0;
-  mmu_.read(&instr_code, PC_, sizeof(uint32_t), 0);
+  HOST_PROFILE(MemAccess, mmu_.read(&instr_code, PC_, sizeof(uint32_t), 0));
 
   DT(2, "IF: instr=0x" << instr_code << ", PC=0x" << std::hex << PC_ << std::dec << " (#" << uuid << ")");
+  OBSERVE(observer_, FETCH, on_fetch(uuid, PC_, instr_code));
+  BT(tracer_, perf_stats_.cycles, Fetch, Stage, uuid, PC_, 0, instr_code);
+  if (konata_) {
+    konata_->fetch(perf_stats_.cycles, uuid, PC_);
+    konata_->stage(perf_stats_.cycles, uuid, "IF");
+  }
 
   // move instruction data to next stage
   if_id_.push({instr_code, PC_, uuid});
@@ -93,11 +151,22 @@ void Core::if_stage() {
 }
 
 void Core::id_stage() {
-  if (if_id_.empty() || !id_ex_.empty())
+  if (if_id_.empty()) {
+    if (stall_cause_ == StallCause::Fill && fetch_stalled_) {
+      stall_cause_ = StallCause::Exit;
+    }
+    return;
+  }
+
+  if (!id_ex_.empty())
     return;
 
   auto& stage_data = if_id_.data();
 
+  if (konata_) {
+    konata_->stage(perf_stats_.cycles, stage_data.uuid, "ID");
+  }
+
   // instruction decode
   auto instr = this->decode(stage_data.instr_code);
 
@@ -116,15 +185,27 @@ void Core::id_stage() {
   }
 
   // check data hazards
-  if (this->check_data_hazards(*instr))
+  if (this->check_data_hazards(*instr)) {
+    BT(tracer_, perf_stats_.cycles, Decode, Stall, stage_data.uuid, stage_data.PC, 0, 0);
     return;
+  }
 
   // register file access
   uint32_t rs1_data, rs2_data;
   this->regfile_read(*instr, &rs1_data, &rs2_data);
 
+  OBSERVE(observer_, DECODE, on_decode(stage_data.uuid, stage_data.PC, *instr));
+  OBSERVE(observer_, ISSUE, on_issue(stage_data.uuid, stage_data.PC, *instr));
+  BT(tracer_, perf_stats_.cycles, Decode, Stage, stage_data.uuid, stage_data.PC, 0, stage_data.instr_code);
+  if (konata_) {
+    std::stringstream ss;
+    ss << *instr;
+    konata_->label(perf_stats_.cycles, stage_data.uuid, ss.str());
+  }
+
   // move instruction data to next stage
   id_ex_.push({instr, rs1_data, rs2_data, stage_data.PC, stage_data.uuid});
+  stall_cause_ = StallCause::None;
   if_id_.pop();
 }
 
@@ -141,6 +222,10 @@ void Core::ex_stage() {
   result = this->branch_unit(*stage_data.instr, stage_data.rs1_data, stage_data.rs2_data, result, stage_data.PC);
 
   DT(2, "EX: result=0x" << std::hex << result << std::dec << " (#" << stage_data.uuid << ")");
+  BT(tracer_, perf_stats_.cycles, Execute, Stage, stage_data.uuid, stage_data.PC, 0, result);
+  if (konata_) {
+    konata_->stage(perf_stats_.cycles, stage_data.uuid, "EX");
+  }
 
   // move instruction data to next stage
   ex_mem_.push({stage_data.instr, stage_data.rs1_data, stage_data.rs2_data, result, stage_data.PC, stage_data.uuid});
@@ -156,6 +241,10 @@ void Core::mem_stage() {
   auto result = this->mem_access(*stage_data.instr, stage_data.result, stage_data.rs2_data);
 
   DT(3, "MEM: result=0x" << std::hex << result << std::dec << " (#" << stage_data.uuid << ")");
+  BT(tracer_, perf_stats_.cycles, Memory, Stage, stage_data.uuid, stage_data.PC, 0, result);
+  if (konata_) {
+    konata_->stage(perf_stats_.cycles, stage_data.uuid, "MEM");
+  }
 
   // move instruction data to next stage
   mem_wb_.push({stage_data.instr, result, stage_data.PC, stage_data.uuid});
@@ -172,6 +261,18 @@ void Core::wb_stage() {
   this->regfile_write(*stage_data.instr, stage_data.result);
 
   DT(3, "WB:" << std::dec << " (#" << stage_data.uuid << ")");
+  BT(tracer_, perf_stats_.cycles, Writeback, Stage, stage_data.uuid, stage_data.PC, 0, stage_data.result);
+  if (konata_) {
+    konata_->stage(perf_stats_.cycles, stage_data.uuid, "WB");
+    konata_->retire(perf_stats_.cycles + 1, stage_data.uuid);
+  }
+  OBSERVE(observer_, COMMIT, on_commit(stage_data.uuid, stage_data.PC, *stage_data.instr));
+  if (pc_profile_) {
+    pc_profile_->commit(stage_data.PC, stage_data.instr);
+  }
+  if (call_profile_) {
+    call_profile_->commit(stage_data.PC, *stage_data.instr);
+  }
 
   assert(perf_stats_.instrs <= fetched_instrs_);
   ++perf_stats_.instrs;
@@ -187,7 +288,28 @@ void Core::wb_stage() {
 /*
  
 
- *bool Core::check_data_hazards(const Instr &instr) {
+ *uint32_t Core::oldest_PC() {
+  // oldest instruction still in flight, called once WB is done
+  if (!ex_mem_.empty())
+    return ex_mem_.data().PC;
+  if (!id_ex_.empty())
+    return id_ex_.data().PC;
+  if (!if_id_.empty())
+    return if_id_.data().PC;
+  return PC_;
+}
+
+void Core::update_cpi_stack(bool retired) {
+  // charge an idle writeback slot to the cause recorded when it left ID
+  auto& wb_slot = issue_slots_[perf_stats_.cycles % issue_slots_.size()];
+  if (!retired) {
+    auto cause = (wb_slot == StallCause::None) ? StallCause::Fill : wb_slot;
+    ++perf_stats_.stalls[(int)cause];
+  }
+  issue_slots_[(perf_stats_.cycles + ISSUE_TO_WB) % issue_slots_.size()] = stall_cause_;
+}
+
+bool Core::check_data_hazards(const Instr &instr) {
   auto exe_flags = instr.getExeFlags();
 
   if (!ex_mem_.empty()) {
@@ -267,6 +389,11 @@ bool Core::check_data_hazards(const Instr &instr) {
         //               << " Rs2=" << id_rs2 << std::endl;
         //return true;
         //std::cout << "TESTING check_data_hazards" << std::endl;
+        stall_cause_ = StallCause::LoadUse;
+        ++hpm_events_[VX_HPM_EVENT_LOAD_USE];
+        if (pattern_profile_) {
+          pattern_profile_->stall(ex_data.PC, 1);
+        }
         return true;  
       }
     }
@@ -394,10 +521,135 @@ bool Core::running() const {
   return (perf_stats_.instrs != fetched_instrs_) || (fetched_instrs_ == 0);
 }
 
-void Core::attach_ram(RAM* ram) {
+void Core::attach_ram(MemDevice* ram) {
   mmu_.attach(*ram, 0, 0xFFFFFFFF);
 }
 
+void Core::track_dirty_pages(uint64_t addr, uint32_t size) {
+  // save the page content before its first write
+  uint64_t first_page = addr / RAM_PAGE_SIZE;
+  uint64_t last_page = (addr + size - 1) / RAM_PAGE_SIZE;
+  for (uint64_t page = first_page; page <= last_page; ++page) {
+    if (dirty_pages_.count(page) != 0)
+      continue;
+    auto& pristine = dirty_pages_[page];
+    pristine.resize(RAM_PAGE_SIZE);
+    mmu_.read(pristine.data(), page * RAM_PAGE_SIZE, RAM_PAGE_SIZE, 0);
+  }
+}
+
+uint32_t Core::restore_dirty_pages() {
+  uint32_t num_pages = dirty_pages_.size();
+  for (auto& it : dirty_pages_) {
+    mmu_.write(it.second.data(), it.first * RAM_PAGE_SIZE, RAM_PAGE_SIZE, 0);
+  }
+  dirty_pages_.clear();
+  return num_pages;
+}
+
+void Core::write_interval() {
+  auto& base = interval_base_;
+  uint64_t cycles = perf_stats_.cycles - base.cycles;
+  uint64_t instrs = perf_stats_.instrs - base.instrs;
+  interval_->begin();
+  interval_->field("cycle", perf_stats_.cycles);
+  interval_->field("cycles", cycles);
+  interval_->field("instrs", instrs);
+  interval_->field("ipc", cycles ? (double(instrs) / cycles) : 0.0);
+  for (int i = (int)StallCause::Fill; i < (int)StallCause::Count; ++i) {
+    auto key = std::string("stall_") + stall_cause_names[i];
+    interval_->field(key.c_str(), perf_stats_.stalls[i] - base.stalls[i]);
+  }
+  interval_->end();
+  interval_base_ = perf_stats_;
+}
+
+void Core::write_stat_page() {
+  stat_page_->begin(perf_stats_.cycles);
+  stat_page_->field("cycles", perf_stats_.cycles);
+  stat_page_->field("instrs", perf_stats_.instrs);
+  for (int i = (int)StallCause::Fill; i < (int)StallCause::Count; ++i) {
+    auto key = std::string("stall_") + stall_cause_names[i];
+    stat_page_->field(key.c_str(), perf_stats_.stalls[i]);
+  }
+  for (int i = VX_HPM_EVENT_NONE + 1; i < VX_HPM_EVENT_COUNT; ++i) {
+    auto key = std::string("hpm_") + hpm_event_names[i];
+    stat_page_->field(key.c_str(), this->hpm_event(i));
+  }
+  stat_page_->field("exited", exited_);
+  stat_page_->end();
+}
+
+std::string Core::read_guest_string(uint32_t addr) {
+  std::string str;
+  for (uint32_t i = 0; i < 64; ++i) {
+    char c = 0;
+    mmu_.read(&c, addr + i, 1, 0);
+    if (c == 0)
+      break;
+    str += c;
+  }
+  return str;
+}
+
+void Core::set_region(uint32_t id) {
+  // close the active region
+  if (region_id_ != 0) {
+    regions_[region_].accumulate(perf_stats_, region_base_);
+    DT(2, "ROI end: " << region_);
+  }
+  region_id_ = id;
+  if (id != 0) {
+    region_ = region_name_.empty() ? ("roi" + std::to_string(id)) : region_name_;
+    region_name_.clear();
+    regions_[region_]; // make sure an unterminated region is still reported
+    region_base_ = perf_stats_;
+    DT(2, "ROI begin: " << region_);
+  }
+}
+
+uint64_t Core::hpm_event(uint32_t event) const {
+  return hpm_events_[event];
+}
+
+uint64_t Core::hpm_counter(uint32_t index) const {
+  return this->hpm_event(mhpmevent_[index]) - mhpmcounter_base_[index];
+}
+
+void Core::set_hpm_counter(uint32_t index, uint64_t value) {
+  // rebase so that the counter resumes counting from value
+  mhpmcounter_base_[index] = this->hpm_event(mhpmevent_[index]) - value;
+}
+
+void Core::set_hpm_event(uint32_t index, uint32_t event) {
+  auto value = this->hpm_counter(index);
+  // WARL: unsupported selectors read back as no event
+  mhpmevent_[index] = (event < VX_HPM_EVENT_COUNT) ? event : VX_HPM_EVENT_NONE;
+  this->set_hpm_counter(index, value);
+}
+
+void Core::print_perf(const std::string& tag, const PerfStats& stats) {
+  std::cout << std::dec << "PERF" << tag << ": instrs=" << stats.instrs << ", cycles=" << stats.cycles << std::endl;
+  if (stats.instrs != 0) {
+    // CPI stack: one cycle per retired instruction plus the idle slots by cause
+    auto instrs = double(stats.instrs);
+    std::cout << std::fixed << std::setprecision(3) << "PERF" << tag << ": cpi_base=" << 1.0;
+    for (int i = (int)StallCause::Fill; i < (int)StallCause::Count; ++i) {
+      std::cout << ", cpi_" << stall_cause_names[i] << "=" << (stats.stalls[i] / instrs);
+    }
+    std::cout << std::defaultfloat << std::endl;
+  }
+}
+
 void Core::showStats() {
-  std::cout << std::dec << "PERF: instrs=" << perf_stats_.instrs << ", cycles=" << perf_stats_.cycles << std::endl;
+  this->print_perf("", perf_stats_);
+
+  for (auto& it : regions_) {
+    auto stats = it.second;
+    if (region_id_ != 0 && it.first == region_) {
+      // region still open at exit
+      stats.accumulate(perf_stats_, region_base_);
+    }
+    this->print_perf("[" + it.first + "]", stats);
+  }
 }
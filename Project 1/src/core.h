@@ -22,12 +22,23 @@
 #include <sstream>
 #include <memory>
 #include <set>
+#include <map>
+#include <array>
 #include <simobject.h>
 #include <mem.h>
 #include "debug.h"
 #include "types.h"
 #include "pipeline.h"
 #include "instr.h"
+#include "observer.h"
+#include "bintrace.h"
+#include "konata.h"
+#include "pcprof.h"
+#include "callprof.h"
+#include "interval.h"
+#include "statpage.h"
+#include "memprof.h"
+#include "patprof.h"
 
 namespace tinyrv {
 
@@ -35,16 +46,38 @@ class ProcessorImpl;
 class Instr;
 class RAM;
 
+// cause charged to a writeback slot that did not retire an instruction
+enum class StallCause {
+  None,     // the slot carries an instruction
+  Fill,     // pipeline fill or empty front-end
+  LoadUse,  // load-use data hazard in ID
+  Csr,      // CSR access serialization in ID
+  Branch,   // wrong-path fetch flushed by a branch
+  Exit,     // fetch locked behind the exit instruction
+  Count
+};
+
 class Core : public SimObject<Core> {
 public:
   struct PerfStats {
     uint64_t cycles;
     uint64_t instrs;
+    uint64_t stalls[(int)StallCause::Count];
 
     PerfStats()
       : cycles(0)
       , instrs(0)
+      , stalls()
     {}
+
+    // adds the counters elapsed between two snapshots
+    void accumulate(const PerfStats& end, const PerfStats& begin) {
+      cycles += end.cycles - begin.cycles;
+      instrs += end.instrs - begin.instrs;
+      for (int i = 0; i < (int)StallCause::Count; ++i) {
+        stalls[i] += end.stalls[i] - begin.stalls[i];
+      }
+    }
   };
 
   Core(const SimContext& ctx, uint32_t core_id, ProcessorImpl* processor);
@@ -54,7 +87,9 @@ public:
 
   void tick();
 
-  void attach_ram(RAM* ram);
+  void attach_ram(MemDevice* ram);
+
+  uint32_t restore_dirty_pages();
 
   bool running() const;
 
@@ -62,8 +97,66 @@ public:
 
   void showStats();
 
+  const PerfStats& perf_stats() const {
+    return perf_stats_;
+  }
+
+  void set_observer(CoreObserver* observer) {
+    observer_ = observer;
+  }
+
+  void attach_tracer(TraceWriter* tracer) {
+    tracer_ = tracer;
+  }
+
+  void attach_konata(KonataWriter* konata) {
+    konata_ = konata;
+  }
+
+  void attach_pc_profile(PCProfiler* pc_profile) {
+    pc_profile_ = pc_profile;
+  }
+
+  void attach_call_profile(CallProfiler* call_profile) {
+    call_profile_ = call_profile;
+  }
+
+  void attach_interval(IntervalWriter* interval) {
+    interval_ = interval;
+  }
+
+  void attach_stat_page(StatPage* stat_page) {
+    stat_page_ = stat_page;
+  }
+
+  void attach_mem_profile(MemProfiler* mem_profile) {
+    mem_profile_ = mem_profile;
+  }
+
+  void attach_pattern_profile(PatternProfiler* pattern_profile) {
+    pattern_profile_ = pattern_profile;
+  }
+
 private:
 
+  void write_interval();
+
+  void write_stat_page();
+
+  void print_perf(const std::string& tag, const PerfStats& stats);
+
+  void set_region(uint32_t id);
+
+  std::string read_guest_string(uint32_t addr);
+
+  uint64_t hpm_event(uint32_t event) const;
+
+  uint64_t hpm_counter(uint32_t index) const;
+
+  void set_hpm_counter(uint32_t index, uint64_t value);
+
+  void set_hpm_event(uint32_t index, uint32_t event);
+
   std::shared_ptr<Instr> decode(uint32_t instr_code) const;
 
   bool check_data_hazards(const Instr &instr);
@@ -88,6 +181,8 @@ private:
 
   void dmem_write(const void* data, uint64_t addr, uint32_t size);
 
+  void track_dirty_pages(uint64_t addr, uint32_t size);
+
   void writeToStdOut(const void* data);
 
   void cout_flush();
@@ -128,6 +223,10 @@ private:
   void mem_stage();
   void wb_stage();
 
+  void update_cpi_stack(bool retired);
+
+  uint32_t oldest_PC();
+
   uint32_t core_id_;
   ProcessorImpl* processor_;
   MemoryUnit mmu_;
@@ -145,9 +244,42 @@ private:
 
   std::stringstream cout_buf_;
 
+  // pristine copies of the guest pages written since the last restore
+  std::unordered_map<uint64_t, std::vector<Byte>> dirty_pages_;
+
   uint64_t uuid_ctr_;
 
+  CoreObserver* observer_;
+  TraceWriter* tracer_;
+  KonataWriter* konata_;
+  PCProfiler* pc_profile_;
+  CallProfiler* call_profile_;
+  IntervalWriter* interval_;
+  StatPage* stat_page_;
+  MemProfiler* mem_profile_;
+  PatternProfiler* pattern_profile_;
+
   PerfStats perf_stats_;
+  PerfStats interval_base_;
+
+  // region-of-interest counters, keyed by region name
+  std::map<std::string, PerfStats> regions_;
+  std::string region_;
+  std::string region_name_;
+  uint32_t    region_id_;
+  PerfStats   region_base_;
+
+  // guest-visible hardware performance monitors: raw event counts, and for
+  // each mhpmcounter its selected event and the count it was rebased from
+  std::array<uint64_t, VX_HPM_EVENT_COUNT> hpm_events_;
+  std::array<uint32_t, VX_HPM_COUNTERS> mhpmevent_;
+  std::array<uint64_t, VX_HPM_COUNTERS> mhpmcounter_base_;
+
+  // issue slot cause of the current cycle, and the causes still travelling
+  // from ID to WB (an instruction issued at cycle c retires at c + 3)
+  static constexpr uint32_t ISSUE_TO_WB = 3;
+  StallCause stall_cause_;
+  std::array<StallCause, ISSUE_TO_WB + 1> issue_slots_;
   uint64_t fetched_instrs_;
 
   friend class Emulator;
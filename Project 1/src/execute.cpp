@@ -12,6 +12,8 @@
 // limitations under the License.
 
 #include <iostream>
+#include <string.h>
+#include <algorithm>
 #include <stdlib.h>
 #include <unistd.h>
 #include <math.h>
@@ -132,6 +134,7 @@ uint32_t Core::branch_unit(const Instr &instr, uint32_t rs1_data, uint32_t rs2_d
   // resolve branches
   if (br_op != BrOp::NONE) {
     auto br_target = rd_data;
+    bool br_mispredict = false;
     if (br_taken) {
       uint32_t next_PC = PC + 4;
       if (br_op == BrOp::JAL || br_op == BrOp::JALR) {
@@ -139,14 +142,28 @@ uint32_t Core::branch_unit(const Instr &instr, uint32_t rs1_data, uint32_t rs2_d
       }
       // check misprediction
       if (br_op != BrOp::JAL && br_target != next_PC) {
+        br_mispredict = true;
+        ++hpm_events_[VX_HPM_EVENT_BPRED_MISS];
+        ++hpm_events_[VX_HPM_EVENT_FLUSH];
+        if (pc_profile_) {
+          pc_profile_->mispredict(PC);
+        }
         PC_ = br_target; // TODO:
         // flush pipeline
+        if (konata_ && !if_id_.empty()) {
+          konata_->flush(perf_stats_.cycles, if_id_.data().uuid);
+        }
         if_id_.reset();
+        stall_cause_ = StallCause::Branch;
         fetch_stalled_ = false;
         DT(2, "*** Branch misprediction: (#" << id_ex_.data().uuid << ")");
+        BT(tracer_, perf_stats_.cycles, Execute, Flush, id_ex_.data().uuid, PC, 0, PC_);
       }
     }
     DT(2, "Branch: " << (br_taken ? "taken" : "not-taken") << ", target=0x" << std::hex << br_target << std::dec << " (#" << id_ex_.data().uuid << ")");
+    OBSERVE(observer_, BRANCH, on_branch(id_ex_.data().uuid, PC, br_taken, (br_taken ? br_target : (PC + 4)), br_mispredict));
+    BT(tracer_, perf_stats_.cycles, Execute, Branch, id_ex_.data().uuid, PC, (br_taken | (br_mispredict << 1)), (br_taken ? br_target : (PC + 4)));
+    __unused (br_mispredict);
   }
 
   return rd_data;
@@ -156,6 +173,10 @@ uint32_t Core::mem_access(const Instr &instr, uint32_t rd_data, uint32_t rs2_dat
   auto exe_flags = instr.getExeFlags();
   auto func3     = instr.getFunc3();
 
+  if (exe_flags.is_load || exe_flags.is_store) {
+    ++hpm_events_[VX_HPM_EVENT_LSU_OPS];
+  }
+
   // handle loads
   if (exe_flags.is_load) {
     uint64_t mem_addr = rd_data;
@@ -163,6 +184,9 @@ uint32_t Core::mem_access(const Instr &instr, uint32_t rd_data, uint32_t rs2_dat
     uint32_t data_width = 8 * data_bytes;
     uint32_t read_data = 0;
     this->dmem_read(&read_data, mem_addr, data_bytes);
+    if (pattern_profile_) {
+      pattern_profile_->access(ex_mem_.data().PC, mem_addr, read_data, true);
+    }
     switch (func3) {
     case 0: // RV32I: LB
     case 1: // RV32I: LH
@@ -184,6 +208,9 @@ uint32_t Core::mem_access(const Instr &instr, uint32_t rd_data, uint32_t rs2_dat
   if (exe_flags.is_store) {
     uint64_t mem_addr = rd_data;
     uint32_t data_bytes = 1 << (func3 & 0x3);
+    if (pattern_profile_) {
+      pattern_profile_->access(ex_mem_.data().PC, mem_addr, rs2_data, false);
+    }
     switch (func3) {
     case 0:
     case 1:
@@ -207,21 +234,44 @@ uint32_t Core::mem_access(const Instr &instr, uint32_t rd_data, uint32_t rs2_dat
 }
 
 void Core::dmem_read(void *data, uint64_t addr, uint32_t size) {
+  HostScope host_scope(HostPhase::MemAccess);
   auto type = get_addr_type(addr);
   __unused (type);
   mmu_.read(data, addr, size, 0);
+  OBSERVE(observer_, DMEM_READ, on_dmem_read(addr, data, size));
+  if (mem_profile_) {
+    mem_profile_->access(addr, size, false, reg_file_.at(2));
+  }
+  if (tracer_) {
+    uint32_t value = 0;
+    memcpy(&value, data, std::min<uint32_t>(size, sizeof(value)));
+    auto& stage_data = ex_mem_.data();
+    BT(tracer_, perf_stats_.cycles, Memory, MemRead, stage_data.uuid, stage_data.PC, size, (addr | (uint64_t(value) << 32)));
+  }
   DTH(2, "Mem Read: addr=0x" << std::hex << addr << ", data=0x" << ByteStream(data, size) << " (size=" << size << ", type=" << type << ")");
 }
 
 void Core::dmem_write(const void* data, uint64_t addr, uint32_t size) {
+  HostScope host_scope(HostPhase::MemAccess);
   auto type = get_addr_type(addr);
   __unused (type);
   if (addr >= uint64_t(IO_COUT_ADDR)
    && addr < (uint64_t(IO_COUT_ADDR) + IO_COUT_SIZE)) {
      this->writeToStdOut(data);
   } else {
+    this->track_dirty_pages(addr, size);
     mmu_.write(data, addr, size, 0);
   }
+  OBSERVE(observer_, DMEM_WRITE, on_dmem_write(addr, data, size));
+  if (mem_profile_) {
+    mem_profile_->access(addr, size, true, reg_file_.at(2));
+  }
+  if (tracer_) {
+    uint32_t value = 0;
+    memcpy(&value, data, std::min<uint32_t>(size, sizeof(value)));
+    auto& stage_data = ex_mem_.data();
+    BT(tracer_, perf_stats_.cycles, Memory, MemWrite, stage_data.uuid, stage_data.PC, size, (addr | (uint64_t(value) << 32)));
+  }
   DTH(2, "Mem Write: addr=0x" << std::hex << addr << ", data=0x" << ByteStream(data, size) << " (size=" << size << ", type=" << type << ")");
 }
 
@@ -240,6 +290,10 @@ uint32_t Core::get_csr(uint32_t addr) {
   case VX_CSR_MEPC:
   case VX_CSR_MNSTATUS:
     return 0;
+  case VX_CSR_ROI:
+    return region_id_;
+  case VX_CSR_ROI_NAME:
+    return 0;
   case VX_CSR_MCYCLE: // NumCycles
     return perf_stats_.cycles & 0xffffffff;
   case VX_CSR_MCYCLE_H: // NumCycles
@@ -249,6 +303,16 @@ uint32_t Core::get_csr(uint32_t addr) {
   case VX_CSR_MINSTRET_H: // NumInsts
     return (uint32_t)(perf_stats_.instrs >> 32);
   default:
+    if (addr >= VX_CSR_MPM_USER && addr < (VX_CSR_MPM_USER + VX_HPM_COUNTERS))
+      return this->hpm_counter(addr - VX_CSR_MPM_USER) & 0xffffffff;
+    if (addr >= VX_CSR_MPM_USER_H && addr < (VX_CSR_MPM_USER_H + VX_HPM_COUNTERS))
+      return (uint32_t)(this->hpm_counter(addr - VX_CSR_MPM_USER_H) >> 32);
+    if (addr >= VX_CSR_HPM_USER && addr < (VX_CSR_HPM_USER + VX_HPM_COUNTERS))
+      return this->hpm_counter(addr - VX_CSR_HPM_USER) & 0xffffffff;
+    if (addr >= VX_CSR_HPM_USER_H && addr < (VX_CSR_HPM_USER_H + VX_HPM_COUNTERS))
+      return (uint32_t)(this->hpm_counter(addr - VX_CSR_HPM_USER_H) >> 32);
+    if (addr >= VX_CSR_MHPMEVENT3 && addr < (VX_CSR_MHPMEVENT3 + VX_HPM_COUNTERS))
+      return mhpmevent_[addr - VX_CSR_MHPMEVENT3];
     std::cout << std::hex << "Error: invalid CSR read addr=0x" << addr << std::endl;
     std::abort();
     return 0;
@@ -268,7 +332,27 @@ void Core::set_csr(uint32_t addr, uint32_t value) {
   case VX_CSR_PMPADDR0:
   case VX_CSR_MNSTATUS:
     break;
+  case VX_CSR_ROI:
+    this->set_region(value);
+    break;
+  case VX_CSR_ROI_NAME:
+    region_name_ = this->read_guest_string(value);
+    break;
   default: {
+      if (addr >= VX_CSR_MPM_USER && addr < (VX_CSR_MPM_USER + VX_HPM_COUNTERS)) {
+        auto index = addr - VX_CSR_MPM_USER;
+        this->set_hpm_counter(index, (this->hpm_counter(index) & 0xffffffff00000000ull) | value);
+        break;
+      }
+      if (addr >= VX_CSR_MPM_USER_H && addr < (VX_CSR_MPM_USER_H + VX_HPM_COUNTERS)) {
+        auto index = addr - VX_CSR_MPM_USER_H;
+        this->set_hpm_counter(index, (this->hpm_counter(index) & 0xffffffff) | (uint64_t(value) << 32));
+        break;
+      }
+      if (addr >= VX_CSR_MHPMEVENT3 && addr < (VX_CSR_MHPMEVENT3 + VX_HPM_COUNTERS)) {
+        this->set_hpm_event(addr - VX_CSR_MHPMEVENT3, value);
+        break;
+      }
       std::cout << std::hex << "Error: invalid CSR write addr=0x" << addr << ", value=0x" << value << std::endl;
       std::abort();
     }
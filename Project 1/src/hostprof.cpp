@@ -0,0 +1,77 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <iomanip>
+#include "hostprof.h"
+
+using namespace tinyrv;
+
+static const char* host_phase_names[] = {"if", "id", "ex", "mem", "wb", "mem_access", "trace", "core", "platform", "other"};
+
+HostProfiler* HostProfiler::active_ = nullptr;
+
+HostProfiler::HostProfiler()
+  : ticks_()
+  , current_(HostPhase::Other)
+  , last_(0)
+  , running_(false)
+  , seconds_(0)
+  , instrs_(0)
+  , cycles_(0)
+  , start_instrs_(0)
+  , start_cycles_(0) {
+  active_ = this;
+}
+
+HostProfiler::~HostProfiler() {
+  if (active_ == this) {
+    active_ = nullptr;
+  }
+}
+
+void HostProfiler::start(uint64_t instrs, uint64_t cycles) {
+  start_instrs_ = instrs;
+  start_cycles_ = cycles;
+  current_ = HostPhase::Other;
+  running_ = true;
+  wall_start_ = std::chrono::steady_clock::now();
+  last_ = now();
+}
+
+void HostProfiler::stop(uint64_t instrs, uint64_t cycles) {
+  if (!running_)
+    return;
+  this->charge();
+  running_ = false;
+  seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start_).count();
+  instrs_ += instrs - start_instrs_;
+  cycles_ += cycles - start_cycles_;
+}
+
+void HostProfiler::print(std::ostream& os) const {
+  uint64_t total = 0;
+  for (auto ticks : ticks_) {
+    total += ticks;
+  }
+  auto seconds = (seconds_ > 0) ? seconds_ : 1e-9;
+  os << std::dec << "HOST: seconds=" << seconds_
+     << ", instrs=" << instrs_ << ", cycles=" << cycles_
+     << ", instrs_per_sec=" << uint64_t(instrs_ / seconds)
+     << ", cycles_per_sec=" << uint64_t(cycles_ / seconds) << std::endl;
+  os << "HOST: ticks=" << total << std::fixed << std::setprecision(1);
+  for (int i = 0; i < (int)HostPhase::Count; ++i) {
+    os << ", " << host_phase_names[i] << "=" << (total ? (100.0 * ticks_[i] / total) : 0.0) << "%";
+  }
+  os << std::defaultfloat << std::endl;
+}
@@ -123,4 +123,10 @@ private:
   friend std::ostream &operator<<(std::ostream &, const Instr&);
 };
 
-}
\ No newline at end of file
+// mnemonic and operands only
+std::ostream &print_asm(std::ostream &os, const Instr &instr);
+
+// decodes a raw instruction word, returns nullptr for an invalid opcode
+std::shared_ptr<Instr> decode_instr(uint32_t instr_code);
+
+}
@@ -0,0 +1,163 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <algorithm>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include "konata.h"
+#include "hostprof.h"
+
+using namespace tinyrv;
+
+KonataWriter::KonataWriter(const char* filename, uint64_t begin_cycle, uint64_t end_cycle)
+  : ofs_(filename)
+  , begin_cycle_(begin_cycle)
+  , end_cycle_(end_cycle)
+  , cur_cycle_(0)
+  , started_(false)
+  , id_ctr_(0)
+  , retire_ctr_(0) {
+  if (!ofs_) {
+    std::cout << "Error: cannot open pipeline trace file " << filename << std::endl;
+    std::abort();
+  }
+  ofs_ << "Kanata\t0004\n";
+}
+
+KonataWriter::~KonataWriter() {
+  this->drain(UINT64_MAX);
+  ofs_.flush();
+}
+
+bool KonataWriter::advance(uint64_t cycle) {
+  if (cycle < begin_cycle_ || cycle > end_cycle_)
+    return false;
+  if (!started_) {
+    ofs_ << "C=\t" << cycle << "\n";
+    cur_cycle_ = cycle;
+    started_ = true;
+  } else if (cycle > cur_cycle_) {
+    this->drain(cycle);
+    if (cycle > cur_cycle_) {
+      ofs_ << "C\t" << (cycle - cur_cycle_) << "\n";
+      cur_cycle_ = cycle;
+    }
+  }
+  return true;
+}
+
+void KonataWriter::drain(uint64_t cycle) {
+  // release the removals scheduled up to the given cycle, in cycle order
+  std::sort(pending_.begin(), pending_.end(), [](const removal_t& a, const removal_t& b) {
+    return a.cycle < b.cycle;
+  });
+  size_t i = 0;
+  for (; i < pending_.size() && pending_[i].cycle <= cycle; ++i) {
+    auto& r = pending_[i];
+    if (r.cycle > cur_cycle_) {
+      ofs_ << "C\t" << (r.cycle - cur_cycle_) << "\n";
+      cur_cycle_ = r.cycle;
+    }
+    auto it = instrs_.find(r.uuid);
+    if (it != instrs_.end()) {
+      auto& instr = it->second;
+      if (instr.emitted) {
+        ofs_ << "R\t" << instr.id << "\t" << (r.type ? 0 : retire_ctr_++) << "\t" << r.type << "\n";
+      }
+      instrs_.erase(it);
+    }
+  }
+  pending_.erase(pending_.begin(), pending_.begin() + i);
+}
+
+KonataWriter::instr_t* KonataWriter::emit(uint64_t uuid) {
+  auto it = instrs_.find(uuid);
+  if (it == instrs_.end())
+    return nullptr;
+  auto& instr = it->second;
+  if (!instr.emitted) {
+    // introduce the instruction with its current stage
+    instr.id = id_ctr_++;
+    instr.emitted = true;
+    ofs_ << "I\t" << instr.id << "\t" << uuid << "\t0\n";
+    ofs_ << "L\t" << instr.id << "\t0\t" << instr.label << "\n";
+    if (instr.stage) {
+      ofs_ << "S\t" << instr.id << "\t0\t" << instr.stage << "\n";
+    }
+  }
+  return &instr;
+}
+
+void KonataWriter::fetch(uint64_t cycle, uint64_t uuid, uint32_t PC) {
+  HostScope host_scope(HostPhase::Trace);
+  std::stringstream ss;
+  ss << std::hex << "0x" << PC << ": ";
+  instrs_[uuid] = {0, ss.str(), nullptr, false};
+  if (this->advance(cycle)) {
+    this->emit(uuid);
+  }
+}
+
+void KonataWriter::label(uint64_t cycle, uint64_t uuid, const std::string& text) {
+  HostScope host_scope(HostPhase::Trace);
+  auto it = instrs_.find(uuid);
+  if (it == instrs_.end())
+    return;
+  it->second.label += text;
+  if (it->second.emitted && this->advance(cycle)) {
+    ofs_ << "L\t" << it->second.id << "\t0\t" << text << "\n";
+  }
+}
+
+void KonataWriter::stage(uint64_t cycle, uint64_t uuid, const char* name) {
+  HostScope host_scope(HostPhase::Trace);
+  auto it = instrs_.find(uuid);
+  if (it == instrs_.end())
+    return;
+  if (it->second.stage && strcmp(it->second.stage, name) == 0)
+    return;
+  it->second.stage = name;
+  if (!this->advance(cycle))
+    return;
+  auto& instr = it->second;
+  if (!instr.emitted) {
+    this->emit(uuid);
+  } else {
+    ofs_ << "S\t" << instr.id << "\t0\t" << name << "\n";
+  }
+}
+
+void KonataWriter::remove(uint64_t cycle, uint64_t uuid, int type) {
+  HostScope host_scope(HostPhase::Trace);
+  if (started_ && cycle > cur_cycle_ && cycle <= end_cycle_) {
+    pending_.push_back({cycle, uuid, type});
+    return;
+  }
+  if (this->advance(cycle)) {
+    auto instr = this->emit(uuid);
+    if (instr) {
+      ofs_ << "R\t" << instr->id << "\t" << (type ? 0 : retire_ctr_++) << "\t" << type << "\n";
+    }
+  }
+  instrs_.erase(uuid);
+}
+
+void KonataWriter::retire(uint64_t cycle, uint64_t uuid) {
+  this->remove(cycle, uuid, 0);
+}
+
+void KonataWriter::flush(uint64_t cycle, uint64_t uuid) {
+  this->remove(cycle, uuid, 1);
+}
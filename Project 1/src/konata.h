@@ -0,0 +1,83 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+namespace tinyrv {
+
+// Pipeline viewer log writer (Kanata 0004 format, opened by Konata).
+// Instructions are keyed by the simulator uuid. Only events inside the
+// [begin_cycle, end_cycle] window are written; instructions already in
+// flight when the window opens are introduced lazily on their next event.
+class KonataWriter {
+public:
+  KonataWriter(const char* filename, uint64_t begin_cycle, uint64_t end_cycle);
+
+  ~KonataWriter();
+
+  // a new instruction entered the pipeline
+  void fetch(uint64_t cycle, uint64_t uuid, uint32_t PC);
+
+  // append text to the instruction label
+  void label(uint64_t cycle, uint64_t uuid, const std::string& text);
+
+  // the instruction entered a stage, repeated calls for the same stage are ignored
+  void stage(uint64_t cycle, uint64_t uuid, const char* name);
+
+  // retirement may be stamped ahead of the current cycle; it is held back
+  // until the writer reaches that cycle
+  void retire(uint64_t cycle, uint64_t uuid);
+
+  void flush(uint64_t cycle, uint64_t uuid);
+
+private:
+
+  struct instr_t {
+    uint64_t    id;
+    std::string label;
+    const char* stage;
+    bool        emitted;
+  };
+
+  struct removal_t {
+    uint64_t cycle;
+    uint64_t uuid;
+    int      type;
+  };
+
+  bool advance(uint64_t cycle);
+
+  instr_t* emit(uint64_t uuid);
+
+  void remove(uint64_t cycle, uint64_t uuid, int type);
+
+  void drain(uint64_t cycle);
+
+  std::ofstream ofs_;
+  uint64_t begin_cycle_;
+  uint64_t end_cycle_;
+  uint64_t cur_cycle_;
+  bool     started_;
+  uint64_t id_ctr_;
+  uint64_t retire_ctr_;
+  std::unordered_map<uint64_t, instr_t> instrs_;
+  std::vector<removal_t> pending_;
+};
+
+}
@@ -0,0 +1,146 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include "patprof.h"
+
+using namespace tinyrv;
+
+// field offsets a pointer-chasing load may add to the loaded pointer
+static constexpr uint32_t CHASE_WINDOW = 256;
+
+static const char* pattern_names[] = {"constant", "strided", "chase", "irregular"};
+
+PatternProfiler::PatternProfiler(const char* filename)
+  : filename_(filename)
+  , accesses_(0)
+  , stall_cycles_(0)
+{}
+
+PatternProfiler::~PatternProfiler() {
+  std::ofstream ofs(filename_);
+  if (!ofs) {
+    std::cout << "Error: cannot open access pattern file " << filename_ << std::endl;
+    return;
+  }
+  this->report(ofs);
+}
+
+void PatternProfiler::access(uint32_t PC, uint32_t addr, uint32_t value, bool is_load) {
+  auto& stats = pcs_[PC];
+  if (stats.accesses != 0) {
+    int32_t delta = addr - stats.last_addr;
+    if (delta == 0) {
+      ++stats.hits[(int)AccessPattern::Constant];
+    } else if (delta == stats.last_delta) {
+      ++stats.hits[(int)AccessPattern::Strided];
+      if (stats.stride_votes == 0) {
+        stats.stride = delta;
+      }
+      stats.stride_votes += (delta == stats.stride) ? 1 : -1;
+    } else if (stats.is_load && (addr - stats.last_value + CHASE_WINDOW) < 2 * CHASE_WINDOW) {
+      ++stats.hits[(int)AccessPattern::Chase];
+    } else {
+      ++stats.hits[(int)AccessPattern::Irregular];
+    }
+    stats.last_delta = delta;
+  }
+  stats.last_addr = addr;
+  stats.last_value = value;
+  stats.is_load = is_load;
+  ++stats.accesses;
+  ++accesses_;
+}
+
+void PatternProfiler::stall(uint32_t PC, uint64_t cycles) {
+  pcs_[PC].stall_cycles += cycles;
+  stall_cycles_ += cycles;
+}
+
+AccessPattern PatternProfiler::classify(const pc_stats_t& stats) {
+  uint64_t transitions = stats.accesses - 1;
+  auto best = AccessPattern::Irregular;
+  uint64_t best_hits = 0;
+  for (int i = 0; i < (int)AccessPattern::Irregular; ++i) {
+    if (stats.hits[i] > best_hits) {
+      best = (AccessPattern)i;
+      best_hits = stats.hits[i];
+    }
+  }
+  if (transitions == 0 || 2 * best_hits < transitions)
+    return AccessPattern::Irregular;
+  return best;
+}
+
+void PatternProfiler::report(std::ostream& os) const {
+  // most frequent accesses first
+  std::vector<std::pair<uint32_t, const pc_stats_t*>> order;
+  for (auto& it : pcs_) {
+    order.push_back({it.first, &it.second});
+  }
+  std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+    return (a.second->accesses != b.second->accesses) ? (a.second->accesses > b.second->accesses) : (a.first < b.first);
+  });
+
+  os << "# accesses=" << accesses_ << ", stall_cycles=" << stall_cycles_ << std::endl;
+  os << "#" << std::setw(11) << "accesses" << std::setw(9) << "%"
+     << std::setw(12) << "stalls" << std::setw(8) << "type"
+     << std::setw(11) << "pattern" << std::setw(10) << "stride"
+     << "  PC" << std::endl;
+  for (auto& it : order) {
+    auto& stats = *it.second;
+    auto pattern = classify(stats);
+    double percent = accesses_ ? (100.0 * stats.accesses / accesses_) : 0.0;
+    os << std::dec << std::setw(12) << stats.accesses
+       << std::setw(8) << std::fixed << std::setprecision(2) << percent << "%" << std::defaultfloat
+       << std::setw(12) << stats.stall_cycles
+       << std::setw(8) << (stats.is_load ? "load" : "store")
+       << std::setw(11) << pattern_names[(int)pattern];
+    if (pattern == AccessPattern::Strided) {
+      os << std::setw(10) << stats.stride;
+    } else {
+      os << std::setw(10) << "-";
+    }
+    os << "  0x" << std::hex << std::setw(8) << std::setfill('0') << it.first << std::setfill(' ') << std::dec << std::endl;
+  }
+}
+
+void PatternProfiler::print_summary(std::ostream& os) const {
+  struct totals_t {
+    uint64_t pcs;
+    uint64_t accesses;
+    uint64_t stall_cycles;
+  };
+  totals_t totals[(int)AccessPattern::Count] = {};
+  for (auto& it : pcs_) {
+    auto& t = totals[(int)classify(it.second)];
+    ++t.pcs;
+    t.accesses += it.second.accesses;
+    t.stall_cycles += it.second.stall_cycles;
+  }
+  // stall cycles of the predictable patterns are what a matching
+  // prefetcher could hide at best
+  for (int i = 0; i < (int)AccessPattern::Count; ++i) {
+    auto& t = totals[i];
+    os << std::dec << "PATTERN[" << pattern_names[i] << "]: pcs=" << t.pcs
+       << ", accesses=" << t.accesses << ", stall_cycles=" << t.stall_cycles
+       << std::fixed << std::setprecision(2)
+       << ", coverage=" << (accesses_ ? (100.0 * t.accesses / accesses_) : 0.0) << "%"
+       << ", stall_share=" << (stall_cycles_ ? (100.0 * t.stall_cycles / stall_cycles_) : 0.0) << "%"
+       << std::defaultfloat << std::endl;
+  }
+}
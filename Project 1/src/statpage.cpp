@@ -0,0 +1,77 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "statpage.h"
+
+using namespace tinyrv;
+
+StatPage::StatPage(const char* filename, uint64_t period)
+  : data_(nullptr)
+  , period_(period)
+  , next_cycle_(0)
+  , fields_(0) {
+  if (period_ == 0) {
+    std::cout << "Error: invalid stats page period" << std::endl;
+    std::abort();
+  }
+  int fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0 || ftruncate(fd, sizeof(StatPageData)) != 0) {
+    std::cout << "Error: cannot create stats page " << filename << std::endl;
+    std::abort();
+  }
+  auto addr = mmap(nullptr, sizeof(StatPageData), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    std::cout << "Error: cannot map stats page " << filename << std::endl;
+    std::abort();
+  }
+  data_ = (StatPageData*)addr;
+  memset(data_, 0, sizeof(StatPageData));
+  data_->version = STATPAGE_VERSION;
+  __atomic_store_n(&data_->magic, STATPAGE_MAGIC, __ATOMIC_RELEASE);
+}
+
+StatPage::~StatPage() {
+  // the last update stays in the file for post-mortem viewing
+  munmap(data_, sizeof(StatPageData));
+}
+
+void StatPage::begin(uint64_t cycle) {
+  next_cycle_ = cycle + period_;
+  fields_ = 0;
+  __atomic_store_n(&data_->seq, data_->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void StatPage::field(const char* key, uint64_t value) {
+  if (fields_ == STATPAGE_COUNTERS)
+    return;
+  // counters are published in a fixed order, so names are written once
+  if (fields_ == data_->count) {
+    strncpy(data_->names[fields_], key, STATPAGE_NAME - 1);
+    ++data_->count;
+  }
+  data_->values[fields_++] = value;
+}
+
+void StatPage::end() {
+  ++data_->updates;
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  __atomic_store_n(&data_->seq, data_->seq + 1, __ATOMIC_RELAXED);
+}
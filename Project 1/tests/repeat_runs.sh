@@ -0,0 +1,56 @@
+#!/bin/sh
+# Copyright 2025 Blaise Tine
+#
+# Licensed under the Apache License;
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Checks that a program restored with reset_to_image() behaves exactly like
+# a fresh run: with -r 2 both runs must print identical PERF lines, for
+# every simulator configuration listed in CONFIGS.
+#
+# usage: repeat_runs.sh <tinyrv> <program>...
+
+CONFIGS="none"
+
+if [ $# -lt 2 ]; then
+  echo "usage: $0 <tinyrv> <program>..."
+  exit 2
+fi
+
+sim="$1"
+shift
+
+status=0
+for program in "$@"; do
+  for config in $CONFIGS; do
+    # configurations are listed with ',' separating their options
+    opts=$(printf '%s' "$config" | tr ',' ' ' | sed 's/^none$//')
+    perf=$("$sim" $opts -r 2 -s "$program" | grep '^PERF')
+    count=$(printf '%s\n' "$perf" | grep -c '^PERF')
+    if [ "$count" -eq 0 ] || [ $((count % 2)) -ne 0 ]; then
+      echo "FAIL: $program [$opts]: expected PERF lines from two runs, got $count"
+      status=1
+      continue
+    fi
+    half=$((count / 2))
+    first=$(printf '%s\n' "$perf" | head -n "$half")
+    second=$(printf '%s\n' "$perf" | tail -n "$half")
+    if [ "$first" != "$second" ]; then
+      echo "FAIL: $program [$opts]: runs differ"
+      printf 'run 1:\n%s\nrun 2:\n%s\n' "$first" "$second"
+      status=1
+    else
+      echo "PASS: $program [$opts]"
+    fi
+  done
+done
+
+exit $status
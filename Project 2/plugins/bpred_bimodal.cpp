@@ -0,0 +1,101 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Sample branch predictor plugin: a bimodal table of 2-bit counters indexed
+// by PC, with a direct-mapped target buffer of the same size.
+//
+// build: g++ -shared -fPIC -O2 -I../src -o bpred_bimodal.so bpred_bimodal.cpp
+// run:   tinyrv --bpred=./bpred_bimodal.so[:<entries>] <program>
+
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+#include "bpred_plugin.h"
+
+namespace {
+
+struct bimodal_t {
+  std::vector<uint8_t>  counters;
+  std::vector<uint32_t> tags;
+  std::vector<uint32_t> targets;
+  uint32_t mask;
+};
+
+void* bimodal_create(const char* args) {
+  uint32_t entries = (args && *args) ? strtoul(args, nullptr, 0) : 1024;
+  // round down to a power of two
+  while (entries & (entries - 1)) {
+    entries &= entries - 1;
+  }
+  if (entries == 0) {
+    entries = 1;
+  }
+  auto bimodal = new bimodal_t();
+  bimodal->counters.resize(entries, 1);
+  bimodal->tags.resize(entries, 0);
+  bimodal->targets.resize(entries, 0);
+  bimodal->mask = entries - 1;
+  return bimodal;
+}
+
+void bimodal_reset(void* ctx) {
+  auto bimodal = (bimodal_t*)ctx;
+  std::fill(bimodal->counters.begin(), bimodal->counters.end(), 1);
+  std::fill(bimodal->tags.begin(), bimodal->tags.end(), 0);
+  std::fill(bimodal->targets.begin(), bimodal->targets.end(), 0);
+}
+
+void bimodal_destroy(void* ctx) {
+  delete (bimodal_t*)ctx;
+}
+
+uint32_t bimodal_predict(void* ctx, uint32_t PC) {
+  auto bimodal = (bimodal_t*)ctx;
+  uint32_t index = (PC >> 2) & bimodal->mask;
+  if (bimodal->counters[index] >= 2 && bimodal->tags[index] == PC) {
+    return bimodal->targets[index];
+  }
+  return PC + 4;
+}
+
+void bimodal_update(void* ctx, uint32_t PC, uint32_t next_PC, int taken) {
+  auto bimodal = (bimodal_t*)ctx;
+  uint32_t index = (PC >> 2) & bimodal->mask;
+  auto& counter = bimodal->counters[index];
+  if (taken) {
+    if (counter < 3) {
+      ++counter;
+    }
+    bimodal->tags[index] = PC;
+    bimodal->targets[index] = next_PC;
+  } else if (counter > 0) {
+    --counter;
+  }
+}
+
+const tinyrv_bpred_plugin_t bimodal_plugin = {
+  TINYRV_BPRED_ABI_VERSION,
+  sizeof(tinyrv_bpred_plugin_t),
+  "bimodal",
+  bimodal_create,
+  bimodal_destroy,
+  bimodal_predict,
+  bimodal_update,
+  bimodal_reset,
+};
+
+}
+
+extern "C" const tinyrv_bpred_plugin_t* tinyrv_bpred_plugin(void) {
+  return &bimodal_plugin;
+}
@@ -0,0 +1,63 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <chrono>
+#include <stdlib.h>
+#include <algorithm>
+#include <assert.h>
+#include "bintrace.h"
+
+using namespace tinyrv;
+
+TraceWriter::TraceWriter(const char* filename, uint32_t core_id, uint32_t capacity)
+  : ring_(capacity)
+  , mask_(capacity - 1)
+  , head_(0)
+  , tail_(0)
+  , stop_(false) {
+  assert((capacity & (capacity - 1)) == 0);
+  file_ = fopen(filename, "wb");
+  if (file_ == nullptr) {
+    std::cout << "Error: cannot open trace file " << filename << std::endl;
+    std::abort();
+  }
+  TraceFileHeader header{TRACE_MAGIC, TRACE_VERSION, sizeof(TraceRecord), core_id};
+  fwrite(&header, sizeof(header), 1, file_);
+  thread_ = std::thread(&TraceWriter::drain, this);
+}
+
+TraceWriter::~TraceWriter() {
+  stop_.store(true, std::memory_order_release);
+  thread_.join();
+  fclose(file_);
+}
+
+void TraceWriter::drain() {
+  for (;;) {
+    bool stop = stop_.load(std::memory_order_acquire);
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+    if (head == tail) {
+      if (stop)
+        break;
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      continue;
+    }
+    // write the contiguous part of the pending records
+    uint64_t start = head & mask_;
+    uint64_t count = std::min<uint64_t>(tail - head, ring_.size() - start);
+    fwrite(&ring_[start], sizeof(TraceRecord), count, file_);
+    head_.store(head + count, std::memory_order_release);
+  }
+}
@@ -0,0 +1,235 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include "bpalias.h"
+
+using namespace tinyrv;
+
+static const char* miss_names[] = {"compulsory", "capacity", "conflict", "aliasing", "inherent"};
+
+static uint8_t train_counter(uint8_t counter, bool taken) {
+  if (taken) {
+    return (counter < 3) ? (counter + 1) : counter;
+  }
+  return (counter > 0) ? (counter - 1) : counter;
+}
+
+template <typename V>
+V* BPredAnalyzer::LRUTable<V>::lookup(uint64_t key) {
+  auto it = map_.find(key);
+  if (it == map_.end())
+    return nullptr;
+  // move to most recently used
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return &it->second->second;
+}
+
+template <typename V>
+V& BPredAnalyzer::LRUTable<V>::insert(uint64_t key, const V& value) {
+  auto it = map_.find(key);
+  if (it != map_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second);
+    it->second->second = value;
+    return it->second->second;
+  }
+  if (lru_.size() >= capacity_) {
+    map_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+  lru_.emplace_front(key, value);
+  map_[key] = lru_.begin();
+  return lru_.front().second;
+}
+
+BPredAnalyzer::BPredAnalyzer(const char* filename)
+  : filename_(filename)
+  , pht_init_(0)
+  , pht_size_(0)
+  , btb_size_(0)
+  , branches_(0)
+  , dir_misses_()
+  , target_misses_()
+{}
+
+BPredAnalyzer::~BPredAnalyzer() {
+  std::ofstream ofs(filename_);
+  if (!ofs) {
+    std::cout << "Error: cannot open predictor alias file " << filename_ << std::endl;
+    return;
+  }
+  this->report(ofs);
+}
+
+void BPredAnalyzer::configure(uint32_t pht_size, uint32_t btb_size, uint8_t pht_init) {
+  pht_size_ = pht_size;
+  btb_size_ = btb_size;
+  pht_init_ = pht_init;
+  fa_pht_.resize(pht_size);
+  fa_btb_.resize(btb_size);
+}
+
+void BPredAnalyzer::update(uint32_t PC, uint32_t history, uint32_t pht_index, uint32_t btb_index,
+                           bool pred_taken, bool btb_hit, uint32_t pred_target,
+                           bool taken, uint32_t next_PC) {
+  ++branches_;
+
+  auto& pht = pht_stats_[pht_index];
+  ++pht.accesses;
+  pht.pcs.insert(PC);
+  pht.histories.insert(history);
+
+  auto& btb = btb_stats_[btb_index];
+  ++btb.accesses;
+  btb.pcs.insert(PC);
+
+  // shadow direction predictions, looked up before training
+  uint64_t key = (uint64_t(PC) << 32) | history;
+  auto inf_it = inf_pht_.find(key);
+  bool inf_seen = (inf_it != inf_pht_.end());
+  uint8_t inf_counter = inf_seen ? inf_it->second : pht_init_;
+  uint8_t* fa_counter = fa_pht_.lookup(key);
+  bool fa_taken = (fa_counter ? *fa_counter : pht_init_) >= 2;
+
+  if (pred_taken != taken) {
+    ++pht.mispredicts;
+    auto kind = BPredMiss::Aliasing;
+    if (!inf_seen) {
+      kind = BPredMiss::Compulsory;
+    } else if ((inf_counter >= 2) != taken) {
+      kind = BPredMiss::Inherent;
+    } else if (fa_taken != taken) {
+      kind = BPredMiss::Capacity;
+    }
+    if (inf_seen && (inf_counter >= 2) == taken) {
+      ++pht.destructive;
+    }
+    ++dir_misses_[(int)kind];
+  } else if (taken && !(btb_hit && pred_target == next_PC)) {
+    ++btb.mispredicts;
+    auto kind = BPredMiss::Conflict;
+    auto inf_target = inf_btb_.find(PC);
+    uint32_t* fa_target = fa_btb_.lookup(PC);
+    if (inf_target == inf_btb_.end()) {
+      kind = BPredMiss::Compulsory;
+    } else if (inf_target->second != next_PC) {
+      kind = BPredMiss::Inherent;
+    } else if (fa_target == nullptr) {
+      kind = BPredMiss::Capacity;
+    }
+    ++target_misses_[(int)kind];
+  }
+
+  // train the shadows the way the real tables are trained
+  inf_pht_[key] = train_counter(inf_counter, taken);
+  if (fa_counter) {
+    *fa_counter = train_counter(*fa_counter, taken);
+  } else {
+    fa_pht_.insert(key, train_counter(pht_init_, taken));
+  }
+  if (taken) {
+    inf_btb_[PC] = next_PC;
+    fa_btb_.insert(PC, next_PC);
+    if (btb.owned && btb.owner != PC) {
+      ++btb.evictions;
+    }
+    btb.owner = PC;
+    btb.owned = true;
+  }
+}
+
+void BPredAnalyzer::report(std::ostream& os) const {
+  // most mispredicting entries first
+  std::vector<std::pair<uint32_t, const pht_stats_t*>> pht_order;
+  for (auto& it : pht_stats_) {
+    pht_order.push_back({it.first, &it.second});
+  }
+  std::sort(pht_order.begin(), pht_order.end(), [](const auto& a, const auto& b) {
+    return (a.second->mispredicts != b.second->mispredicts) ? (a.second->mispredicts > b.second->mispredicts) : (a.first < b.first);
+  });
+  std::vector<std::pair<uint32_t, const btb_stats_t*>> btb_order;
+  for (auto& it : btb_stats_) {
+    btb_order.push_back({it.first, &it.second});
+  }
+  std::sort(btb_order.begin(), btb_order.end(), [](const auto& a, const auto& b) {
+    return (a.second->mispredicts != b.second->mispredicts) ? (a.second->mispredicts > b.second->mispredicts) : (a.first < b.first);
+  });
+
+  os << "# branches=" << branches_ << ", pht_size=" << pht_size_ << ", btb_size=" << btb_size_ << std::endl;
+  os << "# PHT" << std::endl;
+  os << "#" << std::setw(7) << "index" << std::setw(12) << "accesses"
+     << std::setw(10) << "mispred" << std::setw(12) << "destructive"
+     << std::setw(8) << "pcs" << std::setw(10) << "histories" << std::endl;
+  for (auto& it : pht_order) {
+    auto& stats = *it.second;
+    os << std::setw(8) << it.first << std::setw(12) << stats.accesses
+       << std::setw(10) << stats.mispredicts << std::setw(12) << stats.destructive
+       << std::setw(8) << stats.pcs.size() << std::setw(10) << stats.histories.size() << std::endl;
+  }
+  os << "# BTB" << std::endl;
+  os << "#" << std::setw(7) << "index" << std::setw(12) << "accesses"
+     << std::setw(10) << "mispred" << std::setw(12) << "evictions"
+     << std::setw(8) << "pcs" << std::endl;
+  for (auto& it : btb_order) {
+    auto& stats = *it.second;
+    os << std::setw(8) << it.first << std::setw(12) << stats.accesses
+       << std::setw(10) << stats.mispredicts << std::setw(12) << stats.evictions
+       << std::setw(8) << stats.pcs.size() << std::endl;
+  }
+}
+
+void BPredAnalyzer::print_summary(std::ostream& os) const {
+  if (pht_size_ == 0) {
+    os << "ALIAS: predictor has no tables to analyze" << std::endl;
+    return;
+  }
+
+  uint64_t pht_shared = 0, pht_pcs = 0;
+  for (auto& it : pht_stats_) {
+    pht_shared += (it.second.pcs.size() > 1);
+    pht_pcs += it.second.pcs.size();
+  }
+  uint64_t btb_shared = 0, btb_evictions = 0;
+  for (auto& it : btb_stats_) {
+    btb_shared += (it.second.pcs.size() > 1);
+    btb_evictions += it.second.evictions;
+  }
+  os << std::dec << "ALIAS: branches=" << branches_
+     << ", pht_used=" << pht_stats_.size() << "/" << pht_size_
+     << ", pht_shared=" << pht_shared
+     << ", pcs_per_entry=" << std::fixed << std::setprecision(2)
+     << (pht_stats_.empty() ? 0.0 : double(pht_pcs) / pht_stats_.size()) << std::defaultfloat
+     << ", btb_used=" << btb_stats_.size() << "/" << btb_size_
+     << ", btb_shared=" << btb_shared
+     << ", btb_evictions=" << btb_evictions << std::endl;
+
+  // a large capacity share asks for bigger tables, a large aliasing or
+  // conflict share for a better index hash, a large inherent share for a
+  // different predictor
+  uint64_t total = 0;
+  for (int i = 0; i < (int)BPredMiss::Count; ++i) {
+    total += dir_misses_[i] + target_misses_[i];
+  }
+  for (int i = 0; i < (int)BPredMiss::Count; ++i) {
+    uint64_t misses = dir_misses_[i] + target_misses_[i];
+    os << "ALIAS[" << miss_names[i] << "]: direction=" << dir_misses_[i]
+       << ", target=" << target_misses_[i]
+       << std::fixed << std::setprecision(2)
+       << ", share=" << (total ? (100.0 * misses / total) : 0.0) << "%"
+       << std::defaultfloat << std::endl;
+  }
+}
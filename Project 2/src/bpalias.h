@@ -0,0 +1,120 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <ostream>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace tinyrv {
+
+enum class BPredMiss {
+  Compulsory, // first time this branch (PHT: with this history) is seen
+  Capacity,   // a fully-associative table of the same size also misses
+  Conflict,   // BTB: the fully-associative table hits, the indexed one misses
+  Aliasing,   // PHT: the fully-associative table predicts right, the shared one does not
+  Inherent,   // even an infinite predictor gets it wrong
+  Count
+};
+
+// Aliasing and capacity analysis for the table-based predictors.
+// Every resolved branch is replayed against three shadow models of the
+// predictor tables: an infinite one with a private 2-bit counter per
+// (PC, history) and a private target per PC, and fully-associative LRU
+// tables holding as many entries as the real PHT and BTB. Mispredictions
+// are classified from where the shadows agree with the real tables, and
+// the number of distinct PCs and histories mapping to each PHT and BTB
+// index is kept. The per-index report is written when the analyzer is
+// destroyed.
+class BPredAnalyzer {
+public:
+  BPredAnalyzer(const char* filename);
+
+  ~BPredAnalyzer();
+
+  // called by the predictor once its table geometry is known
+  void configure(uint32_t pht_size, uint32_t btb_size, uint8_t pht_init);
+
+  // replays one resolved branch; pred_taken and pred_target describe
+  // what the real tables predicted at pht_index and btb_index
+  void update(uint32_t PC, uint32_t history, uint32_t pht_index, uint32_t btb_index,
+              bool pred_taken, bool btb_hit, uint32_t pred_target,
+              bool taken, uint32_t next_PC);
+
+  void report(std::ostream& os) const;
+
+  void print_summary(std::ostream& os) const;
+
+private:
+
+  // fully-associative LRU shadow table
+  template <typename V>
+  class LRUTable {
+  public:
+    LRUTable() : capacity_(0) {}
+
+    void resize(uint32_t capacity) {
+      capacity_ = capacity;
+    }
+
+    V* lookup(uint64_t key);
+
+    V& insert(uint64_t key, const V& value);
+
+  private:
+    typedef std::list<std::pair<uint64_t, V>> list_t;
+    uint32_t capacity_;
+    list_t lru_;
+    std::unordered_map<uint64_t, typename list_t::iterator> map_;
+  };
+
+  struct pht_stats_t {
+    uint64_t accesses;
+    uint64_t mispredicts;
+    uint64_t destructive;  // mispredictions a private counter would have avoided
+    std::unordered_set<uint32_t> pcs;
+    std::unordered_set<uint32_t> histories;
+  };
+
+  struct btb_stats_t {
+    uint64_t accesses;
+    uint64_t mispredicts;
+    uint64_t evictions;    // taken branch replaced a different PC's entry
+    std::unordered_set<uint32_t> pcs;
+    uint32_t owner;
+    bool     owned;
+  };
+
+  std::string filename_;
+  uint8_t pht_init_;
+  uint32_t pht_size_;
+  uint32_t btb_size_;
+
+  std::unordered_map<uint64_t, uint8_t> inf_pht_;
+  std::unordered_map<uint32_t, uint32_t> inf_btb_;
+  LRUTable<uint8_t>  fa_pht_;
+  LRUTable<uint32_t> fa_btb_;
+
+  std::unordered_map<uint32_t, pht_stats_t> pht_stats_;
+  std::unordered_map<uint32_t, btb_stats_t> btb_stats_;
+
+  uint64_t branches_;
+  uint64_t dir_misses_[(int)BPredMiss::Count];
+  uint64_t target_misses_[(int)BPredMiss::Count];
+};
+
+}
@@ -0,0 +1,63 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Stable C ABI for branch predictor plugins.
+// A plugin is a shared library exporting TINYRV_BPRED_PLUGIN_ENTRY, which
+// returns a table of function pointers. New fields are only ever appended
+// to the table and struct_size tells how much of it a plugin provides, so
+// tables built against an older header stay loadable; optional fields are
+// tested with TINYRV_BPRED_HAS(). abi_version only changes for an
+// incompatible layout. See plugins/bpred_bimodal.cpp for an example.
+
+#define TINYRV_BPRED_ABI_VERSION    2
+#define TINYRV_BPRED_PLUGIN_ENTRY   "tinyrv_bpred_plugin"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  uint32_t abi_version;
+  // sizeof(tinyrv_bpred_plugin_t) in the header the plugin was built with
+  uint32_t struct_size;
+  const char* name;
+  // create a predictor instance, args is the text after ':' on the command line
+  void* (*create)(const char* args);
+  void (*destroy)(void* ctx);
+  // return the predicted next PC
+  uint32_t (*predict)(void* ctx, uint32_t PC);
+  // train with the resolved outcome of a branch
+  void (*update)(void* ctx, uint32_t PC, uint32_t next_PC, int taken);
+  // optional: forget all learned state when the simulated core is reset,
+  // the instance is destroyed and created again if missing
+  void (*reset)(void* ctx);
+} tinyrv_bpred_plugin_t;
+
+// smallest table the simulator accepts: everything up to update
+#define TINYRV_BPRED_MIN_SIZE \
+  (offsetof(tinyrv_bpred_plugin_t, update) + sizeof(((tinyrv_bpred_plugin_t*)0)->update))
+
+// does the plugin's table include the given field?
+#define TINYRV_BPRED_HAS(plugin, field) \
+  ((plugin)->struct_size >= offsetof(tinyrv_bpred_plugin_t, field) + sizeof((plugin)->field))
+
+typedef const tinyrv_bpred_plugin_t* (*tinyrv_bpred_plugin_fn)(void);
+
+#ifdef __cplusplus
+}
+#endif
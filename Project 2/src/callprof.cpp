@@ -0,0 +1,185 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <stdlib.h>
+#include "callprof.h"
+#include "instr.h"
+
+using namespace tinyrv;
+
+static constexpr uint32_t REG_RA = 1;
+
+CallProfiler::CallProfiler(const char* filename, const char* symfile)
+  : filename_(filename)
+  , cur_node_(0)
+  , call_pending_(false)
+  , started_(false) {
+  // root node, bound to the first committed PC
+  nodes_.push_back({0, -1, 0, 0, {}});
+  if (symfile) {
+    this->load_symbols(symfile);
+  }
+}
+
+CallProfiler::~CallProfiler() {
+  std::ofstream ofs(filename_);
+  if (!ofs) {
+    std::cout << "Error: cannot open flame graph file " << filename_ << std::endl;
+    return;
+  }
+  // folded stacks carry the exclusive cost of each path
+  for (int i = 0; i < (int)nodes_.size(); ++i) {
+    if (nodes_[i].cycles != 0) {
+      ofs << this->path(i) << " " << nodes_[i].cycles << std::endl;
+    }
+  }
+}
+
+void CallProfiler::load_symbols(const char* symfile) {
+  // accepts "nm" output: "<hex address> [<type>] <name>"
+  std::ifstream ifs(symfile);
+  if (!ifs) {
+    std::cout << "Error: cannot open symbol map " << symfile << std::endl;
+    std::abort();
+  }
+  std::string line;
+  while (std::getline(ifs, line)) {
+    std::stringstream ss(line);
+    std::string addr, token, name;
+    if (!(ss >> addr))
+      continue;
+    while (ss >> token) {
+      name = token;
+    }
+    if (name.empty())
+      continue;
+    symbols_[strtoul(addr.c_str(), nullptr, 16)] = name;
+  }
+}
+
+std::string CallProfiler::symbol(uint32_t addr) const {
+  std::stringstream ss;
+  auto it = symbols_.upper_bound(addr);
+  if (it != symbols_.begin()) {
+    --it;
+    ss << it->second;
+    if (it->first != addr) {
+      ss << "+0x" << std::hex << (addr - it->first);
+    }
+  } else {
+    ss << "0x" << std::hex << addr;
+  }
+  return ss.str();
+}
+
+std::string CallProfiler::path(int node) const {
+  std::vector<int> frames;
+  for (int i = node; i != -1; i = nodes_[i].parent) {
+    frames.push_back(i);
+  }
+  std::string str;
+  for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+    if (!str.empty()) {
+      str += ";";
+    }
+    str += this->symbol(nodes_[*it].func);
+  }
+  return str;
+}
+
+void CallProfiler::commit(uint32_t PC, const Instr& instr) {
+  if (!started_) {
+    nodes_[0].func = PC;
+    started_ = true;
+  }
+
+  // enter the callee on its first instruction
+  if (call_pending_) {
+    auto& children = nodes_[cur_node_].children;
+    auto it = children.find(PC);
+    if (it == children.end()) {
+      int child = nodes_.size();
+      children[PC] = child;
+      nodes_.push_back({PC, cur_node_, 0, 0, {}});
+      cur_node_ = child;
+    } else {
+      cur_node_ = it->second;
+    }
+    call_pending_ = false;
+  }
+
+  ++nodes_[cur_node_].instrs;
+
+  auto br_op = instr.getBrOp();
+  if (br_op != BrOp::JAL && br_op != BrOp::JALR)
+    return;
+
+  if (instr.getRd() == REG_RA) {
+    call_pending_ = true;
+  } else if (br_op == BrOp::JALR
+          && instr.getRd() == 0
+          && instr.getRs1() == REG_RA
+          && nodes_[cur_node_].parent != -1) {
+    cur_node_ = nodes_[cur_node_].parent;
+  }
+}
+
+void CallProfiler::print_summary(std::ostream& os) const {
+  struct cost_t {
+    uint64_t incl_cycles;
+    uint64_t excl_cycles;
+    uint64_t excl_instrs;
+  };
+  std::map<uint32_t, cost_t> funcs;
+  uint64_t total_cycles = 0;
+
+  for (int i = 0; i < (int)nodes_.size(); ++i) {
+    auto& node = nodes_[i];
+    auto& cost = funcs[node.func];
+    cost.excl_cycles += node.cycles;
+    cost.excl_instrs += node.instrs;
+    total_cycles += node.cycles;
+    // charge inclusive cost once per function along the path (recursion)
+    std::vector<uint32_t> seen;
+    for (int j = i; j != -1; j = nodes_[j].parent) {
+      auto func = nodes_[j].func;
+      if (std::find(seen.begin(), seen.end(), func) != seen.end())
+        continue;
+      seen.push_back(func);
+      funcs[func].incl_cycles += node.cycles;
+    }
+  }
+
+  std::vector<std::pair<uint32_t, cost_t>> order(funcs.begin(), funcs.end());
+  std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+    return a.second.incl_cycles > b.second.incl_cycles;
+  });
+
+  for (auto& it : order) {
+    auto& cost = it.second;
+    double incl = total_cycles ? (100.0 * cost.incl_cycles / total_cycles) : 0.0;
+    double excl = total_cycles ? (100.0 * cost.excl_cycles / total_cycles) : 0.0;
+    os << "FUNC: " << this->symbol(it.first)
+       << ": incl_cycles=" << cost.incl_cycles
+       << " (" << std::fixed << std::setprecision(2) << incl << "%)"
+       << ", excl_cycles=" << cost.excl_cycles
+       << " (" << excl << "%)" << std::defaultfloat
+       << ", excl_instrs=" << cost.excl_instrs
+       << std::endl;
+  }
+}
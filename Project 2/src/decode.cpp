@@ -163,7 +163,7 @@ static const char* op_string(const Instr &instr) {
   }
 }
 
-std::ostream &operator<<(std::ostream &os, const Instr &instr) {
+std::ostream &print_asm(std::ostream &os, const Instr &instr) {
   os << op_string(instr);
   int sep = 0;
 
@@ -189,6 +189,12 @@ std::ostream &operator<<(std::ostream &os, const Instr &instr) {
     os << "0x" << std::hex << instr.getImm();
   }
 
+  return os;
+}
+
+std::ostream &operator<<(std::ostream &os, const Instr &instr) {
+  print_asm(os, instr);
+
   os << std::dec << ", alu_op=" << instr.getAluOp()
       << ", br_op=" << instr.getBrOp()
      << ", exe_flags=" << instr.getExeFlags();
@@ -199,6 +205,10 @@ std::ostream &operator<<(std::ostream &os, const Instr &instr) {
 }
 
 std::shared_ptr<Instr> Core::decode(uint32_t instr_code) const {
+  return decode_instr(instr_code);
+}
+
+std::shared_ptr<Instr> tinyrv::decode_instr(uint32_t instr_code) {
   auto instr = std::make_shared<Instr>();
   auto opcode = Opcode((instr_code >> shift_opcode) & mask_opcode);
 
@@ -0,0 +1,501 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <algorithm>
+#include <assert.h>
+#include <util.h>
+#include "emulator.h"
+
+using namespace tinyrv;
+
+static_assert((LANE_ICACHE_SIZE & (LANE_ICACHE_SIZE - 1)) == 0, "LANE_ICACHE_SIZE must be a power of two");
+
+typedef Emulator::lane_vec_t lane_vec_t;
+typedef Emulator::lane_svec_t lane_svec_t;
+
+static inline lane_vec_t splat(Word value) {
+  lane_vec_t vec = {};
+  return vec + value;
+}
+
+// all-ones in the lanes where the branch condition holds
+static inline lane_vec_t branch_taken(BrOp br_op, lane_vec_t a, lane_vec_t b) {
+  switch (br_op) {
+  case BrOp::BEQ:  return (lane_vec_t)(a == b);
+  case BrOp::BNE:  return (lane_vec_t)(a != b);
+  case BrOp::BLT:  return (lane_vec_t)((lane_svec_t)a < (lane_svec_t)b);
+  case BrOp::BGE:  return (lane_vec_t)((lane_svec_t)a >= (lane_svec_t)b);
+  case BrOp::BLTU: return (lane_vec_t)(a < b);
+  case BrOp::BGEU: return (lane_vec_t)(a >= b);
+  default:         return ~lane_vec_t{};
+  }
+}
+
+Emulator::Emulator(const std::vector<MemDevice*>& mems)
+  : mems_(mems)
+  , num_lanes_(mems.size())
+  , num_vecs_((mems.size() + LANE_VECTOR_WIDTH - 1) / LANE_VECTOR_WIDTH)
+  , regs_(NUM_REGS * num_vecs_)
+  , PCs_(num_vecs_)
+  , next_PCs_(num_vecs_)
+  , exited_(num_vecs_)
+  , mask_(num_vecs_)
+  , alu_s1_(num_vecs_)
+  , alu_s2_(num_vecs_)
+  , result_(num_vecs_)
+  , instret_lo_(num_vecs_)
+  , instret_hi_(num_vecs_)
+  , csrs_(mems.size())
+  , cout_bufs_(mems.size())
+  , icache_(LANE_ICACHE_SIZE)
+{
+  this->reset();
+}
+
+Emulator::~Emulator() {}
+
+void Emulator::reset() {
+  std::fill(regs_.begin(), regs_.end(), lane_vec_t{});
+  std::fill(PCs_.begin(), PCs_.end(), splat(STARTUP_ADDR));
+  std::fill(instret_lo_.begin(), instret_lo_.end(), lane_vec_t{});
+  std::fill(instret_hi_.begin(), instret_hi_.end(), lane_vec_t{});
+  // padding lanes of the last vector never run
+  std::fill(exited_.begin(), exited_.end(), ~lane_vec_t{});
+  for (uint32_t l = 0; l < num_lanes_; ++l) {
+    regs_[10 * num_vecs_ + l / LANE_VECTOR_WIDTH][l % LANE_VECTOR_WIDTH] = l;
+    regs_[11 * num_vecs_ + l / LANE_VECTOR_WIDTH][l % LANE_VECTOR_WIDTH] = num_lanes_;
+    exited_[l / LANE_VECTOR_WIDTH][l % LANE_VECTOR_WIDTH] = 0;
+  }
+  for (auto& csrs : csrs_) {
+    csrs.region_id = 0;
+    csrs.region.clear();
+    csrs.region_name.clear();
+    csrs.region_instrs = 0;
+    csrs.region_steps = 0;
+    csrs.lsu_ops = 0;
+    std::fill_n(csrs.mhpmevent, VX_HPM_COUNTERS, VX_HPM_EVENT_NONE);
+    std::fill_n(csrs.mhpmcounter_base, VX_HPM_COUNTERS, 0);
+  }
+  regions_.clear();
+  for (auto& buf : cout_bufs_) {
+    buf.clear();
+  }
+  perf_stats_ = PerfStats();
+}
+
+std::vector<int> Emulator::run(bool riscv_test) {
+  this->reset();
+
+  while (this->step());
+
+  std::vector<int> exitcodes(num_lanes_);
+  for (uint32_t l = 0; l < num_lanes_; ++l) {
+    Word ec = this->reg(3, l);
+    exitcodes[l] = riscv_test ? (1 - ec) : ec;
+  }
+  return exitcodes;
+}
+
+const Instr* Emulator::fetch(uint32_t lane, Word PC) {
+  auto& entry = icache_[(PC >> 2) & (LANE_ICACHE_SIZE - 1)];
+  if (entry.instr && entry.PC == PC)
+    return entry.instr.get();
+  uint32_t instr_code = 0;
+  mems_.at(lane)->read(&instr_code, PC, sizeof(uint32_t));
+  auto instr = decode_instr(instr_code);
+  if (!instr) {
+    std::cout << std::hex << "Error: invalid instruction at PC=0x" << PC << std::dec << std::endl;
+    std::abort();
+  }
+  entry.PC = PC;
+  entry.instr = instr;
+  return entry.instr.get();
+}
+
+bool Emulator::step() {
+  uint32_t n = num_vecs_;
+
+  // select the group of running lanes with the lowest PC,
+  // exited lanes read as all-ones and never win the reduction
+  lane_vec_t min_PCs = ~lane_vec_t{};
+  for (uint32_t v = 0; v < n; ++v) {
+    lane_vec_t PCs = PCs_[v] | exited_[v];
+    min_PCs = (PCs < min_PCs) ? PCs : min_PCs;
+  }
+  Word PC = ~Word(0);
+  for (uint32_t j = 0; j < LANE_VECTOR_WIDTH; ++j) {
+    PC = std::min<Word>(PC, min_PCs[j]);
+  }
+  if (PC == ~Word(0))
+    return false;
+
+  lane_vec_t vPC = splat(PC);
+  lane_vec_t active = {};
+  lane_vec_t waiting = {};
+  for (uint32_t v = 0; v < n; ++v) {
+    lane_vec_t mask = (lane_vec_t)(PCs_[v] == vPC) & ~exited_[v];
+    mask_[v] = mask;
+    active -= mask;
+    waiting |= ~mask & ~exited_[v];
+  }
+  uint32_t num_active = 0;
+  bool divergent = false;
+  for (uint32_t j = 0; j < LANE_VECTOR_WIDTH; ++j) {
+    num_active += active[j];
+    divergent |= (waiting[j] != 0);
+  }
+
+  uint32_t leader = 0;
+  while (!this->lane(mask_, leader)) {
+    ++leader;
+  }
+
+  auto instr = this->fetch(leader, PC);
+  this->execute(*instr, PC);
+
+  ++perf_stats_.steps;
+  perf_stats_.lane_instrs += num_active;
+  if (divergent) {
+    ++perf_stats_.divergent_steps;
+  }
+  return true;
+}
+
+void Emulator::execute(const Instr& instr, Word PC) {
+  auto exe_flags = instr.getExeFlags();
+  auto alu_op = instr.getAluOp();
+  auto br_op = instr.getBrOp();
+  auto imm = instr.getImm();
+  uint32_t n = num_vecs_;
+  auto rs1_data = &regs_[instr.getRs1() * n];
+  auto rs2_data = &regs_[instr.getRs2() * n];
+  lane_vec_t zero = {};
+
+  // source operands
+  if (exe_flags.alu_s1_PC) {
+    std::fill_n(alu_s1_.begin(), n, splat(PC));
+  } else if (exe_flags.alu_s1_rs1) {
+    std::fill_n(alu_s1_.begin(), n, splat(instr.getRs1()));
+  } else if (exe_flags.use_rs1) {
+    std::copy_n(rs1_data, n, alu_s1_.begin());
+  } else {
+    std::fill_n(alu_s1_.begin(), n, zero);
+  }
+  if (exe_flags.alu_s1_inv) {
+    for (uint32_t v = 0; v < n; ++v) alu_s1_[v] = ~alu_s1_[v];
+  }
+  if (exe_flags.alu_s2_imm) {
+    std::fill_n(alu_s2_.begin(), n, splat(imm));
+  } else if (exe_flags.is_csr) {
+    std::fill_n(alu_s2_.begin(), n, zero);
+    for (uint32_t l = 0; l < num_lanes_; ++l) {
+      if (this->lane(mask_, l)) {
+        alu_s2_[l / LANE_VECTOR_WIDTH][l % LANE_VECTOR_WIDTH] = this->get_csr(l, imm);
+      }
+    }
+  } else if (exe_flags.use_rs2) {
+    std::copy_n(rs2_data, n, alu_s2_.begin());
+  } else {
+    std::fill_n(alu_s2_.begin(), n, zero);
+  }
+
+  // ALU operations
+  switch (alu_op) {
+  case AluOp::NONE:
+    std::fill_n(result_.begin(), n, zero);
+    break;
+  case AluOp::ADD:
+    for (uint32_t v = 0; v < n; ++v) result_[v] = alu_s1_[v] + alu_s2_[v];
+    break;
+  case AluOp::SUB:
+    for (uint32_t v = 0; v < n; ++v) result_[v] = alu_s1_[v] - alu_s2_[v];
+    break;
+  case AluOp::AND:
+    for (uint32_t v = 0; v < n; ++v) result_[v] = alu_s1_[v] & alu_s2_[v];
+    break;
+  case AluOp::OR:
+    for (uint32_t v = 0; v < n; ++v) result_[v] = alu_s1_[v] | alu_s2_[v];
+    break;
+  case AluOp::XOR:
+    for (uint32_t v = 0; v < n; ++v) result_[v] = alu_s1_[v] ^ alu_s2_[v];
+    break;
+  case AluOp::SLL:
+    for (uint32_t v = 0; v < n; ++v) result_[v] = alu_s1_[v] << (alu_s2_[v] & 0x1f);
+    break;
+  case AluOp::SRL:
+    for (uint32_t v = 0; v < n; ++v) result_[v] = alu_s1_[v] >> (alu_s2_[v] & 0x1f);
+    break;
+  case AluOp::SRA:
+    for (uint32_t v = 0; v < n; ++v) result_[v] = (lane_vec_t)((lane_svec_t)alu_s1_[v] >> (lane_svec_t)(alu_s2_[v] & 0x1f));
+    break;
+  case AluOp::LTI:
+    for (uint32_t v = 0; v < n; ++v) result_[v] = (lane_vec_t)((lane_svec_t)alu_s1_[v] < (lane_svec_t)alu_s2_[v]) & 1;
+    break;
+  case AluOp::LTU:
+    for (uint32_t v = 0; v < n; ++v) result_[v] = (lane_vec_t)(alu_s1_[v] < alu_s2_[v]) & 1;
+    break;
+  default:
+    std::abort();
+  }
+
+  // Branch operations
+  lane_vec_t PC_4 = splat(PC + 4);
+  if (br_op == BrOp::NONE) {
+    std::fill_n(next_PCs_.begin(), n, PC_4);
+  } else {
+    for (uint32_t v = 0; v < n; ++v) {
+      lane_vec_t a = exe_flags.use_rs1 ? rs1_data[v] : zero;
+      lane_vec_t b = exe_flags.use_rs2 ? rs2_data[v] : zero;
+      lane_vec_t taken = branch_taken(br_op, a, b);
+      next_PCs_[v] = (result_[v] & taken) | (PC_4 & ~taken);
+    }
+    if (br_op == BrOp::JAL || br_op == BrOp::JALR) {
+      std::fill_n(result_.begin(), n, PC_4);
+    }
+  }
+
+  // memory access and CSR writes
+  this->mem_access(instr);
+
+  // register write-back
+  if (exe_flags.use_rd && instr.getRd() != 0) {
+    auto rd_data = &regs_[instr.getRd() * n];
+    for (uint32_t v = 0; v < n; ++v) {
+      rd_data[v] = (result_[v] & mask_[v]) | (rd_data[v] & ~mask_[v]);
+    }
+  }
+
+  // advance the active lanes
+  lane_vec_t exit = exe_flags.is_exit ? ~zero : zero;
+  for (uint32_t v = 0; v < n; ++v) {
+    lane_vec_t mask = mask_[v];
+    PCs_[v] = (next_PCs_[v] & mask) | (PCs_[v] & ~mask);
+    // 64-bit instret as a lo/hi pair, mask lanes are -1
+    lane_vec_t lo = instret_lo_[v] - mask;
+    instret_hi_[v] -= (lane_vec_t)(lo == zero) & mask;
+    instret_lo_[v] = lo;
+    exited_[v] |= mask & exit;
+  }
+}
+
+void Emulator::mem_access(const Instr& instr) {
+  auto exe_flags = instr.getExeFlags();
+  auto func3 = instr.getFunc3();
+
+  if (exe_flags.is_load) {
+    uint32_t data_bytes = 1 << (func3 & 0x3);
+    uint32_t data_width = 8 * data_bytes;
+    for (uint32_t l = 0; l < num_lanes_; ++l) {
+      if (!this->lane(mask_, l))
+        continue;
+      auto& result = result_[l / LANE_VECTOR_WIDTH][l % LANE_VECTOR_WIDTH];
+      uint32_t read_data = 0;
+      mems_[l]->read(&read_data, result, data_bytes);
+      result = (func3 & 0x4) ? read_data : sext(read_data, data_width);
+      ++csrs_[l].lsu_ops;
+    }
+  }
+
+  if (exe_flags.is_store) {
+    uint32_t data_bytes = 1 << (func3 & 0x3);
+    for (uint32_t l = 0; l < num_lanes_; ++l) {
+      if (!this->lane(mask_, l))
+        continue;
+      uint64_t mem_addr = this->lane(result_, l);
+      Word data = this->reg(instr.getRs2(), l);
+      if (mem_addr >= uint64_t(IO_COUT_ADDR)
+       && mem_addr < (uint64_t(IO_COUT_ADDR) + IO_COUT_SIZE)) {
+        cout_bufs_[l] += (char)data;
+      } else {
+        mems_[l]->write(&data, mem_addr, data_bytes);
+      }
+      ++csrs_[l].lsu_ops;
+    }
+  }
+
+  if (exe_flags.is_csr) {
+    for (uint32_t l = 0; l < num_lanes_; ++l) {
+      if (!this->lane(mask_, l))
+        continue;
+      auto& result = result_[l / LANE_VECTOR_WIDTH][l % LANE_VECTOR_WIDTH];
+      Word csr_data = this->lane(alu_s2_, l);
+      if (result != csr_data) {
+        this->set_csr(l, instr.getImm(), result);
+      }
+      result = csr_data;
+    }
+  }
+}
+
+uint32_t Emulator::get_csr(uint32_t l, uint32_t addr) {
+  auto& csrs = csrs_[l];
+  // every lane advances one instruction per step it is active,
+  // so the lockstep step count is the shared cycle counter
+  uint64_t cycles = perf_stats_.steps;
+  switch (addr) {
+  case VX_CSR_MHARTID:
+  case VX_CSR_SATP:
+  case VX_CSR_PMPCFG0:
+  case VX_CSR_PMPADDR0:
+  case VX_CSR_MSTATUS:
+  case VX_CSR_MISA:
+  case VX_CSR_MEDELEG:
+  case VX_CSR_MIDELEG:
+  case VX_CSR_MIE:
+  case VX_CSR_MTVEC:
+  case VX_CSR_MEPC:
+  case VX_CSR_MNSTATUS:
+    return 0;
+  case VX_CSR_ROI:
+    return csrs.region_id;
+  case VX_CSR_ROI_NAME:
+    return 0;
+  case VX_CSR_MCYCLE:
+    return cycles & 0xffffffff;
+  case VX_CSR_MCYCLE_H:
+    return (uint32_t)(cycles >> 32);
+  case VX_CSR_MINSTRET:
+    return this->instret(l) & 0xffffffff;
+  case VX_CSR_MINSTRET_H:
+    return (uint32_t)(this->instret(l) >> 32);
+  default:
+    if (addr >= VX_CSR_MPM_USER && addr < (VX_CSR_MPM_USER + VX_HPM_COUNTERS))
+      return this->hpm_counter(l, addr - VX_CSR_MPM_USER) & 0xffffffff;
+    if (addr >= VX_CSR_MPM_USER_H && addr < (VX_CSR_MPM_USER_H + VX_HPM_COUNTERS))
+      return (uint32_t)(this->hpm_counter(l, addr - VX_CSR_MPM_USER_H) >> 32);
+    if (addr >= VX_CSR_HPM_USER && addr < (VX_CSR_HPM_USER + VX_HPM_COUNTERS))
+      return this->hpm_counter(l, addr - VX_CSR_HPM_USER) & 0xffffffff;
+    if (addr >= VX_CSR_HPM_USER_H && addr < (VX_CSR_HPM_USER_H + VX_HPM_COUNTERS))
+      return (uint32_t)(this->hpm_counter(l, addr - VX_CSR_HPM_USER_H) >> 32);
+    if (addr >= VX_CSR_MHPMEVENT3 && addr < (VX_CSR_MHPMEVENT3 + VX_HPM_COUNTERS))
+      return csrs.mhpmevent[addr - VX_CSR_MHPMEVENT3];
+    std::cout << std::hex << "Error: invalid CSR read addr=0x" << addr << " (lane " << std::dec << l << ")" << std::endl;
+    std::abort();
+    return 0;
+  }
+}
+
+void Emulator::set_csr(uint32_t l, uint32_t addr, uint32_t value) {
+  auto& csrs = csrs_[l];
+  switch (addr) {
+  case VX_CSR_SATP:
+  case VX_CSR_MSTATUS:
+  case VX_CSR_MEDELEG:
+  case VX_CSR_MIDELEG:
+  case VX_CSR_MIE:
+  case VX_CSR_MTVEC:
+  case VX_CSR_MEPC:
+  case VX_CSR_PMPCFG0:
+  case VX_CSR_PMPADDR0:
+  case VX_CSR_MNSTATUS:
+    break;
+  case VX_CSR_ROI:
+    this->set_region(l, value);
+    break;
+  case VX_CSR_ROI_NAME:
+    csrs.region_name = this->read_guest_string(l, value);
+    break;
+  default: {
+      if (addr >= VX_CSR_MPM_USER && addr < (VX_CSR_MPM_USER + VX_HPM_COUNTERS)) {
+        auto index = addr - VX_CSR_MPM_USER;
+        uint64_t counter = (this->hpm_counter(l, index) & 0xffffffff00000000ull) | value;
+        csrs.mhpmcounter_base[index] = this->hpm_event(l, csrs.mhpmevent[index]) - counter;
+        break;
+      }
+      if (addr >= VX_CSR_MPM_USER_H && addr < (VX_CSR_MPM_USER_H + VX_HPM_COUNTERS)) {
+        auto index = addr - VX_CSR_MPM_USER_H;
+        uint64_t counter = (this->hpm_counter(l, index) & 0xffffffff) | (uint64_t(value) << 32);
+        csrs.mhpmcounter_base[index] = this->hpm_event(l, csrs.mhpmevent[index]) - counter;
+        break;
+      }
+      if (addr >= VX_CSR_MHPMEVENT3 && addr < (VX_CSR_MHPMEVENT3 + VX_HPM_COUNTERS)) {
+        auto index = addr - VX_CSR_MHPMEVENT3;
+        uint64_t counter = this->hpm_counter(l, index);
+        // WARL: unsupported selectors read back as no event
+        csrs.mhpmevent[index] = (value < VX_HPM_EVENT_COUNT) ? value : VX_HPM_EVENT_NONE;
+        csrs.mhpmcounter_base[index] = this->hpm_event(l, csrs.mhpmevent[index]) - counter;
+        break;
+      }
+      std::cout << std::hex << "Error: invalid CSR write addr=0x" << addr << ", value=0x" << value << " (lane " << std::dec << l << ")" << std::endl;
+      std::abort();
+    }
+  }
+}
+
+uint64_t Emulator::hpm_event(uint32_t l, uint32_t event) const {
+  // pipeline events never occur in a functional engine
+  if (event == VX_HPM_EVENT_LSU_OPS)
+    return csrs_[l].lsu_ops;
+  return 0;
+}
+
+uint64_t Emulator::hpm_counter(uint32_t l, uint32_t index) const {
+  auto& csrs = csrs_[l];
+  return this->hpm_event(l, csrs.mhpmevent[index]) - csrs.mhpmcounter_base[index];
+}
+
+std::string Emulator::read_guest_string(uint32_t l, uint32_t addr) {
+  std::string str;
+  for (uint32_t i = 0; i < 64; ++i) {
+    char c = 0;
+    mems_[l]->read(&c, addr + i, 1);
+    if (c == 0)
+      break;
+    str += c;
+  }
+  return str;
+}
+
+void Emulator::set_region(uint32_t l, uint32_t id) {
+  auto& csrs = csrs_[l];
+  // close the active region, the CSR write itself is not counted
+  if (csrs.region_id != 0) {
+    auto& stats = regions_[csrs.region];
+    stats.instrs += this->instret(l) - csrs.region_instrs;
+    stats.cycles += perf_stats_.steps - csrs.region_steps;
+  }
+  csrs.region_id = id;
+  if (id != 0) {
+    csrs.region = csrs.region_name.empty() ? ("roi" + std::to_string(id)) : csrs.region_name;
+    csrs.region_name.clear();
+    regions_[csrs.region]; // make sure an unterminated region is still reported
+    csrs.region_instrs = this->instret(l);
+    csrs.region_steps = perf_stats_.steps;
+  }
+}
+
+void Emulator::showStats() {
+  double efficiency = perf_stats_.steps ? (double(perf_stats_.lane_instrs) / (perf_stats_.steps * num_lanes_)) : 0;
+  std::cout << std::dec << "PERF: lanes=" << num_lanes_
+            << ", steps=" << perf_stats_.steps
+            << ", lane_instrs=" << perf_stats_.lane_instrs
+            << ", divergent_steps=" << perf_stats_.divergent_steps
+            << ", lane_efficiency=" << efficiency << std::endl;
+
+  // region counters are summed over the lanes
+  auto regions = regions_;
+  for (uint32_t l = 0; l < num_lanes_; ++l) {
+    auto& csrs = csrs_[l];
+    if (csrs.region_id != 0) {
+      // region still open at exit
+      auto& stats = regions[csrs.region];
+      stats.instrs += this->instret(l) - csrs.region_instrs;
+      stats.cycles += perf_stats_.steps - csrs.region_steps;
+    }
+  }
+  for (auto& it : regions) {
+    std::cout << "PERF[" << it.first << "]: instrs=" << it.second.instrs
+              << ", cycles=" << it.second.cycles << std::endl;
+  }
+}
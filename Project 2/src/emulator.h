@@ -0,0 +1,154 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <map>
+#include <mem.h>
+#include "types.h"
+#include "instr.h"
+
+namespace tinyrv {
+
+// Functional engine running N guest harts of the same binary in lockstep.
+// The register file is a flat [reg][lane] array of 32-bit words held in
+// LANE_VECTOR_WIDTH-wide GCC vectors, so every ALU and branch operation is a
+// masked SIMD loop over the lanes. Loads, stores and CSR accesses remain
+// per-lane since each lane has its own memory view.
+// Diverged lanes are grouped by PC and the lowest PC group executes first,
+// which lets groups reconverge as soon as their PCs meet again.
+// Each lane starts with a0 = its lane index and a1 = the number of lanes,
+// and may have its own input data in its memory view.
+class Emulator {
+public:
+  typedef uint32_t lane_vec_t __attribute__((vector_size(4 * LANE_VECTOR_WIDTH)));
+  typedef int32_t  lane_svec_t __attribute__((vector_size(4 * LANE_VECTOR_WIDTH)));
+
+  struct PerfStats {
+    uint64_t steps;
+    uint64_t lane_instrs;
+    uint64_t divergent_steps;
+
+    PerfStats()
+      : steps(0)
+      , lane_instrs(0)
+      , divergent_steps(0)
+    {}
+  };
+
+  Emulator(const std::vector<MemDevice*>& mems);
+
+  ~Emulator();
+
+  void reset();
+
+  // run until all lanes exit, returns the per-lane exit codes
+  std::vector<int> run(bool riscv_test);
+
+  const std::string& lane_output(uint32_t lane) const {
+    return cout_bufs_.at(lane);
+  }
+
+  void showStats();
+
+private:
+
+  struct icache_entry_t {
+    Word PC;
+    std::shared_ptr<Instr> instr;
+  };
+
+  struct RegionStats {
+    uint64_t instrs;
+    uint64_t cycles;
+
+    RegionStats()
+      : instrs(0)
+      , cycles(0)
+    {}
+  };
+
+  // per-lane CSR state
+  struct LaneCsrs {
+    uint32_t    region_id;
+    std::string region;
+    std::string region_name;
+    uint64_t    region_instrs;
+    uint64_t    region_steps;
+    uint64_t    lsu_ops;
+    uint32_t    mhpmevent[VX_HPM_COUNTERS];
+    uint64_t    mhpmcounter_base[VX_HPM_COUNTERS];
+  };
+
+  bool step();
+
+  const Instr* fetch(uint32_t lane, Word PC);
+
+  void execute(const Instr& instr, Word PC);
+
+  void mem_access(const Instr& instr);
+
+  Word lane(const std::vector<lane_vec_t>& vec, uint32_t l) const {
+    return vec[l / LANE_VECTOR_WIDTH][l % LANE_VECTOR_WIDTH];
+  }
+
+  Word reg(uint32_t r, uint32_t l) const {
+    return regs_[r * num_vecs_ + l / LANE_VECTOR_WIDTH][l % LANE_VECTOR_WIDTH];
+  }
+
+  uint64_t instret(uint32_t l) const {
+    return (uint64_t(this->lane(instret_hi_, l)) << 32) | this->lane(instret_lo_, l);
+  }
+
+  uint32_t get_csr(uint32_t l, uint32_t addr);
+
+  void set_csr(uint32_t l, uint32_t addr, uint32_t value);
+
+  void set_region(uint32_t l, uint32_t id);
+
+  std::string read_guest_string(uint32_t l, uint32_t addr);
+
+  uint64_t hpm_event(uint32_t l, uint32_t event) const;
+
+  uint64_t hpm_counter(uint32_t l, uint32_t index) const;
+
+  std::vector<MemDevice*> mems_;
+  uint32_t num_lanes_;
+  uint32_t num_vecs_;
+
+  std::vector<lane_vec_t> regs_; // [reg][lane]
+  std::vector<lane_vec_t> PCs_;
+  std::vector<lane_vec_t> next_PCs_;
+  std::vector<lane_vec_t> exited_;
+  std::vector<lane_vec_t> mask_;
+  std::vector<lane_vec_t> alu_s1_;
+  std::vector<lane_vec_t> alu_s2_;
+  std::vector<lane_vec_t> result_;
+  std::vector<lane_vec_t> instret_lo_;
+  std::vector<lane_vec_t> instret_hi_;
+
+  std::vector<LaneCsrs> csrs_;
+  std::map<std::string, RegionStats> regions_;
+
+  std::vector<std::string> cout_bufs_;
+
+  // decoded instructions, the program text is assumed to be read-only
+  std::vector<icache_entry_t> icache_;
+
+  PerfStats perf_stats_;
+};
+
+}
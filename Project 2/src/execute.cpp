@@ -12,6 +12,8 @@
 // limitations under the License.
 
 #include <iostream>
+#include <string.h>
+#include <algorithm>
 #include <stdlib.h>
 #include <unistd.h>
 #include <math.h>
@@ -145,12 +147,22 @@ uint32_t Core::branch_unit(const Instr &instr, uint32_t rs1_data, uint32_t rs2_d
     }
 
     // check misprediction
-    if (next_PC != if_id_->data().PC) {
+    bool br_mispredict = (next_PC != if_id_->data().PC);
+    if (br_mispredict) {
       perf_stats_.bpred_miss++;
+      ++hpm_events_[VX_HPM_EVENT_FLUSH];
+      if (pc_profile_) {
+        pc_profile_->mispredict(PC);
+      }
       // update PC
       PC_ = next_PC;
       // flush pipeline
+      if (konata_ && if_id_->valid()) {
+        konata_->flush(perf_stats_.cycles, if_id_->data().uuid);
+      }
       if_id_->reset();
+      stall_cause_ = StallCause::Branch;
+      BT(tracer_, perf_stats_.cycles, Execute, Flush, id_ex_->data().uuid, PC, 0, PC_);
       if (br_op == BrOp::JAL || br_op == BrOp::JALR) {
         DT(2, "*** Branch target misprediction: (#" << id_ex_->data().uuid << ")");
       } else {
@@ -159,10 +171,12 @@ uint32_t Core::branch_unit(const Instr &instr, uint32_t rs1_data, uint32_t rs2_d
     }
 
     // update gshare predictor
-    if (gshare_enabled) {
+    if (bpred_) {
       bpred_->update(PC, next_PC, br_taken);
     }
     DT(2, "Branch: " << (br_taken ? "taken" : "not-taken") << ", target=0x" << std::hex << br_target << std::dec << " (#" << id_ex_->data().uuid << ")");
+    OBSERVE(observer_, BRANCH, on_branch(id_ex_->data().uuid, PC, br_taken, next_PC, br_mispredict));
+    BT(tracer_, perf_stats_.cycles, Execute, Branch, id_ex_->data().uuid, PC, (br_taken | (br_mispredict << 1)), next_PC);
   }
 
   return rd_data;
@@ -172,12 +186,19 @@ uint32_t Core::mem_access(const Instr &instr, uint32_t rd_data, uint32_t rs2_dat
   auto exe_flags = instr.getExeFlags();
   auto func3     = instr.getFunc3();
 
+  if (exe_flags.is_load || exe_flags.is_store) {
+    ++hpm_events_[VX_HPM_EVENT_LSU_OPS];
+  }
+
   if (exe_flags.is_load) {
     uint64_t mem_addr = rd_data;
     uint32_t data_bytes = 1 << (func3 & 0x3);
     uint32_t data_width = 8 * data_bytes;
     uint32_t read_data = 0;
     this->dmem_read(&read_data, mem_addr, data_bytes);
+    if (pattern_profile_) {
+      pattern_profile_->access(ex_mem_->data().PC, mem_addr, read_data, true);
+    }
     switch (func3) {
     case 0: // RV32I: LB
     case 1: // RV32I: LH
@@ -198,6 +219,9 @@ uint32_t Core::mem_access(const Instr &instr, uint32_t rd_data, uint32_t rs2_dat
   if (exe_flags.is_store) {
     uint64_t mem_addr = rd_data;
     uint32_t data_bytes = 1 << (func3 & 0x3);
+    if (pattern_profile_) {
+      pattern_profile_->access(ex_mem_->data().PC, mem_addr, rs2_data, false);
+    }
     switch (func3) {
     case 0:
     case 1:
@@ -220,21 +244,44 @@ uint32_t Core::mem_access(const Instr &instr, uint32_t rd_data, uint32_t rs2_dat
 }
 
 void Core::dmem_read(void *data, uint64_t addr, uint32_t size) {
+  HostScope host_scope(HostPhase::MemAccess);
   auto type = get_addr_type(addr);
   __unused (type);
   mmu_.read(data, addr, size, 0);
+  OBSERVE(observer_, DMEM_READ, on_dmem_read(addr, data, size));
+  if (mem_profile_) {
+    mem_profile_->access(addr, size, false, reg_file_.at(2));
+  }
+  if (tracer_) {
+    uint32_t value = 0;
+    memcpy(&value, data, std::min<uint32_t>(size, sizeof(value)));
+    auto& stage_data = ex_mem_->data();
+    BT(tracer_, perf_stats_.cycles, Memory, MemRead, stage_data.uuid, stage_data.PC, size, (addr | (uint64_t(value) << 32)));
+  }
   DT(2, "Mem Read: addr=0x" << std::hex << addr << ", data=0x" << ByteStream(data, size) << " (size=" << size << ", type=" << type << ")");
 }
 
 void Core::dmem_write(const void* data, uint64_t addr, uint32_t size) {
+  HostScope host_scope(HostPhase::MemAccess);
   auto type = get_addr_type(addr);
   __unused (type);
   if (addr >= uint64_t(IO_COUT_ADDR)
    && addr < (uint64_t(IO_COUT_ADDR) + IO_COUT_SIZE)) {
      this->writeToStdOut(data);
   } else {
+    this->track_dirty_pages(addr, size);
     mmu_.write(data, addr, size, 0);
   }
+  OBSERVE(observer_, DMEM_WRITE, on_dmem_write(addr, data, size));
+  if (mem_profile_) {
+    mem_profile_->access(addr, size, true, reg_file_.at(2));
+  }
+  if (tracer_) {
+    uint32_t value = 0;
+    memcpy(&value, data, std::min<uint32_t>(size, sizeof(value)));
+    auto& stage_data = ex_mem_->data();
+    BT(tracer_, perf_stats_.cycles, Memory, MemWrite, stage_data.uuid, stage_data.PC, size, (addr | (uint64_t(value) << 32)));
+  }
   DT(2, "Mem Write: addr=0x" << std::hex << addr << ", data=0x" << ByteStream(data, size) << " (size=" << size << ", type=" << type << ")");
 }
 
@@ -255,6 +302,10 @@ uint32_t Core::get_csr(uint32_t addr) {
   case VX_CSR_MEPC:
   case VX_CSR_MNSTATUS:
     return 0;
+  case VX_CSR_ROI:
+    return region_id_;
+  case VX_CSR_ROI_NAME:
+    return 0;
   case VX_CSR_MCYCLE: // NumCycles
 	return ideal_mcycles & 0xffffffff;
   case VX_CSR_MCYCLE_H: // NumCycles
@@ -264,6 +315,16 @@ uint32_t Core::get_csr(uint32_t addr) {
   case VX_CSR_MINSTRET_H: // NumInsts
     return (uint32_t)(perf_stats_.instrs >> 32);
   default:
+    if (addr >= VX_CSR_MPM_USER && addr < (VX_CSR_MPM_USER + VX_HPM_COUNTERS))
+      return this->hpm_counter(addr - VX_CSR_MPM_USER) & 0xffffffff;
+    if (addr >= VX_CSR_MPM_USER_H && addr < (VX_CSR_MPM_USER_H + VX_HPM_COUNTERS))
+      return (uint32_t)(this->hpm_counter(addr - VX_CSR_MPM_USER_H) >> 32);
+    if (addr >= VX_CSR_HPM_USER && addr < (VX_CSR_HPM_USER + VX_HPM_COUNTERS))
+      return this->hpm_counter(addr - VX_CSR_HPM_USER) & 0xffffffff;
+    if (addr >= VX_CSR_HPM_USER_H && addr < (VX_CSR_HPM_USER_H + VX_HPM_COUNTERS))
+      return (uint32_t)(this->hpm_counter(addr - VX_CSR_HPM_USER_H) >> 32);
+    if (addr >= VX_CSR_MHPMEVENT3 && addr < (VX_CSR_MHPMEVENT3 + VX_HPM_COUNTERS))
+      return mhpmevent_[addr - VX_CSR_MHPMEVENT3];
     std::cout << std::hex << "Error: invalid CSR read addr=0x" << addr << std::endl;
     std::abort();
     return 0;
@@ -283,7 +344,27 @@ void Core::set_csr(uint32_t addr, uint32_t value) {
   case VX_CSR_PMPADDR0:
   case VX_CSR_MNSTATUS:
     break;
+  case VX_CSR_ROI:
+    this->set_region(value);
+    break;
+  case VX_CSR_ROI_NAME:
+    region_name_ = this->read_guest_string(value);
+    break;
   default: {
+      if (addr >= VX_CSR_MPM_USER && addr < (VX_CSR_MPM_USER + VX_HPM_COUNTERS)) {
+        auto index = addr - VX_CSR_MPM_USER;
+        this->set_hpm_counter(index, (this->hpm_counter(index) & 0xffffffff00000000ull) | value);
+        break;
+      }
+      if (addr >= VX_CSR_MPM_USER_H && addr < (VX_CSR_MPM_USER_H + VX_HPM_COUNTERS)) {
+        auto index = addr - VX_CSR_MPM_USER_H;
+        this->set_hpm_counter(index, (this->hpm_counter(index) & 0xffffffff) | (uint64_t(value) << 32));
+        break;
+      }
+      if (addr >= VX_CSR_MHPMEVENT3 && addr < (VX_CSR_MHPMEVENT3 + VX_HPM_COUNTERS)) {
+        this->set_hpm_event(addr - VX_CSR_MHPMEVENT3, value);
+        break;
+      }
       std::cout << std::hex << "Error: invalid CSR write addr=0x" << addr << ", value=0x" << value << std::endl;
       std::abort();
     }
@@ -14,6 +14,8 @@
 
 #include <iostream>
 #include <assert.h>
+#include <algorithm>
+#include <dlfcn.h>
 #include <util.h>
 #include "types.h"
 #include "core.h"
@@ -29,7 +31,8 @@ GShare::GShare(uint32_t BTB_size, uint32_t BHR_size)
   , BHR_(0x0)
   , BTB_shift_(log2ceil(BTB_size))
   , BTB_mask_(BTB_size-1)
-  , BHR_mask_((1 << BHR_size)-1) {
+  , BHR_mask_((1 << BHR_size)-1)
+  , analyzer_(nullptr) {
   //--
 }
 
@@ -37,6 +40,17 @@ GShare::~GShare() {
   //--
 }
 
+void GShare::reset() {
+  std::fill(BTB_.begin(), BTB_.end(), BTB_entry_t{false, 0x0, 0x0});
+  std::fill(PHT_.begin(), PHT_.end(), 0x0);
+  BHR_ = 0x0;
+}
+
+void GShare::attach_analyzer(BPredAnalyzer* analyzer) {
+  analyzer_ = analyzer;
+  analyzer_->configure(PHT_.size(), BTB_.size(), 0x0);
+}
+
 uint32_t GShare::predict(uint32_t PC) {
   uint32_t next_PC = PC + 4;
   uint8_t pht_index = ((PC>>2) ^ BHR_) & BHR_mask_;
@@ -67,6 +81,16 @@ void GShare::update(uint32_t PC, uint32_t next_PC, bool taken) {
   // TODO:
   //update PHT
   uint8_t pht_index = ((PC>>2) ^ BHR_) & BHR_mask_;
+
+  // replay the prediction the tables hold before training them
+  if (analyzer_) {
+    uint32_t btb_index = (PC >> 2) & BTB_mask_;
+    auto& btb_entry = BTB_[btb_index];
+    bool btb_hit = btb_entry.valid && btb_entry.tag == ((PC >> 2) >> BTB_shift_);
+    analyzer_->update(PC, BHR_, pht_index, btb_index, PHT_[pht_index] >= 2,
+                      btb_hit, btb_entry.target, taken, next_PC);
+  }
+
   if(taken){
     if(PHT_[pht_index] < 3){
       PHT_[pht_index]++;
@@ -106,7 +130,8 @@ GSharePlus::GSharePlus(uint32_t BTB_size, uint32_t BHR_size)
   , BHR_(0x0)
   , BTB_shift_(log2ceil(BTB_size))
   , BTB_mask_(BTB_size-1)
-  , BHR_mask_((1 << BHR_size)-1) {
+  , BHR_mask_((1 << BHR_size)-1)
+  , analyzer_(nullptr) {
   //--
 }
 
@@ -114,6 +139,17 @@ GSharePlus::~GSharePlus() {
   //--
 }
 
+void GSharePlus::reset() {
+  std::fill(BTB_.begin(), BTB_.end(), BTB_entry_t{false, 0x0, 0x0});
+  std::fill(PHT_.begin(), PHT_.end(), 0x2);
+  BHR_ = 0x0;
+}
+
+void GSharePlus::attach_analyzer(BPredAnalyzer* analyzer) {
+  analyzer_ = analyzer;
+  analyzer_->configure(PHT_.size(), BTB_.size(), 0x2);
+}
+
 uint32_t GSharePlus::predict(uint32_t PC) {
   uint32_t next_PC = PC + 4;
   uint16_t pht_index = ((PC>>2) ^ BHR_) & BHR_mask_;
@@ -144,6 +180,16 @@ void GSharePlus::update(uint32_t PC, uint32_t next_PC, bool taken) {
   // TODO:
   //update PHT
   uint16_t pht_index = ((PC>>2) ^ BHR_) & BHR_mask_;
+
+  // replay the prediction the tables hold before training them
+  if (analyzer_) {
+    uint32_t btb_index = (PC >> 2) & BTB_mask_;
+    auto& btb_entry = BTB_[btb_index];
+    bool btb_hit = btb_entry.valid && btb_entry.tag == ((PC >> 2) >> BTB_shift_);
+    analyzer_->update(PC, BHR_, pht_index, btb_index, PHT_[pht_index] >= 2,
+                      btb_hit, btb_entry.target, taken, next_PC);
+  }
+
   if(taken){
   if(PHT_[pht_index] < 3){
     PHT_[pht_index]++;
@@ -175,4 +221,71 @@ void GSharePlus::update(uint32_t PC, uint32_t next_PC, bool taken) {
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+PluginPredictor::PluginPredictor(const std::string& spec)
+  : args_()
+  , handle_(nullptr)
+  , plugin_(nullptr)
+  , ctx_(nullptr) {
+  auto sep = spec.find(':');
+  auto path = spec.substr(0, sep);
+  args_ = (sep != std::string::npos) ? spec.substr(sep + 1) : std::string();
+
+  handle_ = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle_ == nullptr) {
+    std::cout << "Error: cannot load predictor plugin: " << dlerror() << std::endl;
+    std::abort();
+  }
+
+  auto entry = (tinyrv_bpred_plugin_fn)dlsym(handle_, TINYRV_BPRED_PLUGIN_ENTRY);
+  if (entry == nullptr) {
+    std::cout << "Error: " << path << " does not export " << TINYRV_BPRED_PLUGIN_ENTRY << std::endl;
+    std::abort();
+  }
+
+  // tables from older headers are a prefix of the current one
+  plugin_ = entry();
+  if (plugin_ == nullptr
+   || plugin_->abi_version != TINYRV_BPRED_ABI_VERSION
+   || plugin_->struct_size < TINYRV_BPRED_MIN_SIZE) {
+    std::cout << "Error: " << path << " has an incompatible predictor ABI version" << std::endl;
+    std::abort();
+  }
+  if (plugin_->create == nullptr || plugin_->predict == nullptr || plugin_->update == nullptr) {
+    std::cout << "Error: " << path << " does not implement create, predict and update" << std::endl;
+    std::abort();
+  }
+
+  ctx_ = plugin_->create(args_.c_str());
+  DT(2, "*** Plugin: loaded predictor " << (plugin_->name ? plugin_->name : "<unnamed>") << " from " << path << " (args=" << args_ << ")");
+}
+
+PluginPredictor::~PluginPredictor() {
+  if (plugin_ && plugin_->destroy) {
+    plugin_->destroy(ctx_);
+  }
+  if (handle_) {
+    dlclose(handle_);
+  }
+}
+
+void PluginPredictor::reset() {
+  if (TINYRV_BPRED_HAS(plugin_, reset) && plugin_->reset) {
+    plugin_->reset(ctx_);
+    return;
+  }
+  // plugins without a reset hook get a fresh instance
+  if (plugin_->destroy) {
+    plugin_->destroy(ctx_);
+  }
+  ctx_ = plugin_->create(args_.c_str());
+}
+
+uint32_t PluginPredictor::predict(uint32_t PC) {
+  return plugin_->predict(ctx_, PC);
+}
 
+void PluginPredictor::update(uint32_t PC, uint32_t next_PC, bool taken) {
+  plugin_->update(ctx_, PC, next_PC, taken);
+}
@@ -14,6 +14,9 @@
 #pragma once
 
 #include <vector>
+#include <string>
+#include "bpred_plugin.h"
+#include "bpalias.h"
 
 namespace tinyrv {
 
@@ -21,6 +24,9 @@ class BranchPredictor {
 public:
   virtual ~BranchPredictor() {}
 
+  // forget everything learned, called when the core is reset
+  virtual void reset() {};
+
   virtual uint32_t predict(uint32_t PC) {
       return PC + 4;
   };
@@ -30,6 +36,11 @@ public:
       (void) next_PC;
       (void) taken;
   };
+
+  // predictors without inspectable tables ignore the analyzer
+  virtual void attach_analyzer(BPredAnalyzer* analyzer) {
+      (void) analyzer;
+  };
 };
 
 struct BTB_entry_t{
@@ -44,8 +55,10 @@ public:
 
   ~GShare() override;
 
+  void reset() override;
   uint32_t predict(uint32_t PC) override;
   void update(uint32_t PC, uint32_t next_PC, bool taken) override;
+  void attach_analyzer(BPredAnalyzer* analyzer) override;
 
   // TODO: Add your own methods here
 
@@ -55,6 +68,7 @@ public:
   uint32_t BTB_shift_;            // Shift for BTB indexing
   uint32_t BTB_mask_;             // Mask for BTB indexing
   uint8_t BHR_mask_;             // Mask for BHR indexing
+  BPredAnalyzer* analyzer_;       // Optional aliasing analysis
 
 
 };
@@ -65,8 +79,10 @@ public:
 
   ~GSharePlus() override;
 
+  void reset() override;
   uint32_t predict(uint32_t PC) override;
   void update(uint32_t PC, uint32_t next_PC, bool taken) override;
+  void attach_analyzer(BPredAnalyzer* analyzer) override;
 
   // TODO: extra credit component
 
@@ -76,7 +92,26 @@ public:
   uint32_t BTB_shift_;            // Shift for BTB indexing
   uint32_t BTB_mask_;             // Mask for BTB indexing
   uint16_t BHR_mask_;             // Mask for BHR indexing
+  BPredAnalyzer* analyzer_;       // Optional aliasing analysis
+
+};
+
+// Predictor loaded from a shared library, spec is "<library.so>[:<args>]"
+class PluginPredictor : public BranchPredictor {
+public:
+  PluginPredictor(const std::string& spec);
+
+  ~PluginPredictor() override;
+
+  void reset() override;
+  uint32_t predict(uint32_t PC) override;
+  void update(uint32_t PC, uint32_t next_PC, bool taken) override;
 
+private:
+  std::string args_;
+  void* handle_;
+  const tinyrv_bpred_plugin_t* plugin_;
+  void* ctx_;
 };
 
 }
@@ -0,0 +1,134 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <ostream>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace tinyrv {
+
+// host-side phases the simulator's own time is charged to
+enum class HostPhase {
+  IF,          // fetch stage
+  ID,          // decode stage
+  EX,          // execute stage
+  MEM,         // memory stage
+  WB,          // writeback stage
+  MemAccess,   // instruction and data memory accesses
+  Trace,       // binary trace, pipeline view and interval writers
+  Core,        // core bookkeeping outside the stages
+  Platform,    // SimPlatform::tick outside the core
+  Other,       // run loop and exit checks
+  Count
+};
+
+// Host self-profiler. Time is read from the TSC and charged to the innermost
+// active phase only, so a memory access inside a stage is not counted twice.
+// Scopes find the profiler through active(), which keeps the hooks in the
+// trace writers free of extra plumbing and costs a null check when disabled.
+class HostProfiler {
+public:
+  HostProfiler();
+
+  ~HostProfiler();
+
+  static HostProfiler* active() {
+    return active_;
+  }
+
+  static uint64_t now() {
+  #if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+  #else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  #endif
+  }
+
+  // brackets a simulation run with the core counters at its ends
+  void start(uint64_t instrs, uint64_t cycles);
+
+  void stop(uint64_t instrs, uint64_t cycles);
+
+  HostPhase enter(HostPhase phase) {
+    auto prev = current_;
+    this->charge();
+    current_ = phase;
+    return prev;
+  }
+
+  void leave(HostPhase prev) {
+    this->charge();
+    current_ = prev;
+  }
+
+  void print(std::ostream& os) const;
+
+private:
+
+  void charge() {
+    if (!running_)
+      return;
+    auto t = now();
+    ticks_[(int)current_] += t - last_;
+    last_ = t;
+  }
+
+  static HostProfiler* active_;
+
+  uint64_t  ticks_[(int)HostPhase::Count];
+  HostPhase current_;
+  uint64_t  last_;
+  bool      running_;
+  std::chrono::steady_clock::time_point wall_start_;
+  double    seconds_;
+  uint64_t  instrs_;
+  uint64_t  cycles_;
+  uint64_t  start_instrs_;
+  uint64_t  start_cycles_;
+};
+
+// charges the enclosing scope to a host phase
+class HostScope {
+public:
+  HostScope(HostPhase phase)
+    : profiler_(HostProfiler::active())
+    , prev_(HostPhase::Other) {
+    if (profiler_) {
+      prev_ = profiler_->enter(phase);
+    }
+  }
+
+  ~HostScope() {
+    if (profiler_) {
+      profiler_->leave(prev_);
+    }
+  }
+
+private:
+  HostProfiler* profiler_;
+  HostPhase     prev_;
+};
+
+#define HOST_PROFILE(phase, stmt) \
+  do { \
+    HostScope __host_scope(HostPhase::phase); \
+    stmt; \
+  } while (0)
+
+}
@@ -0,0 +1,257 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <util.h>
+#include "image.h"
+
+using namespace tinyrv;
+
+ProgramImage::ProgramImage(uint32_t page_size)
+  : page_size_(page_size)
+  , mapping_(nullptr)
+  , mapping_size_(0)
+{}
+
+ProgramImage::~ProgramImage() {
+  if (mapping_) {
+    munmap(mapping_, mapping_size_);
+  }
+}
+
+void ProgramImage::write(const void* data, uint64_t addr, uint64_t size) {
+  auto src = (const Byte*)data;
+  while (size != 0) {
+    uint64_t page_index = addr / page_size_;
+    uint64_t offset = addr % page_size_;
+    uint64_t chunk = std::min<uint64_t>(size, page_size_ - offset);
+    auto& page = private_pages_[page_index];
+    if (page.empty()) {
+      auto mapped = this->page(page_index);
+      if (mapped) {
+        page.assign(mapped, mapped + page_size_);
+      } else {
+        page.resize(page_size_, 0);
+      }
+      pages_[page_index] = page.data();
+    }
+    memcpy(page.data() + offset, src, chunk);
+    src  += chunk;
+    addr += chunk;
+    size -= chunk;
+  }
+}
+
+bool ProgramImage::loadBinImage(const char* filename, uint64_t destination) {
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    std::cout << "*** error: " << filename << " not found" << std::endl;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    std::cout << "*** error: cannot stat " << filename << std::endl;
+    close(fd);
+    return false;
+  }
+  uint64_t size = st.st_size;
+
+  // map the whole pages read-only, they are never written through
+  uint64_t mapped = 0;
+  if (mapping_ == nullptr && (destination % page_size_) == 0) {
+    mapped = (size / page_size_) * page_size_;
+    if (mapped != 0) {
+      void* mapping = mmap(nullptr, mapped, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping != MAP_FAILED) {
+        mapping_ = mapping;
+        mapping_size_ = mapped;
+        for (uint64_t offset = 0; offset < mapped; offset += page_size_) {
+          pages_[(destination + offset) / page_size_] = (const Byte*)mapping + offset;
+        }
+      } else {
+        mapped = 0;
+      }
+    }
+  }
+
+  // copy the partial last page, or the whole file if it could not be mapped
+  std::vector<Byte> content(size - mapped);
+  uint64_t done = 0;
+  while (done < content.size()) {
+    auto n = pread(fd, content.data() + done, content.size() - done, mapped + done);
+    if (n <= 0) {
+      std::cout << "*** error: cannot read " << filename << std::endl;
+      close(fd);
+      return false;
+    }
+    done += n;
+  }
+  close(fd);
+  this->write(content.data(), destination + mapped, content.size());
+  return true;
+}
+
+bool ProgramImage::loadHexImage(const char* filename) {
+  std::ifstream ifs(filename);
+  if (!ifs) {
+    std::cout << "*** error: " << filename << " not found" << std::endl;
+    return false;
+  }
+
+  // Intel HEX records
+  uint64_t base_addr = 0;
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (line.size() < 11 || line[0] != ':')
+      continue;
+    auto hex_byte = [&](uint32_t pos) {
+      return (uint32_t)std::stoul(line.substr(pos, 2), nullptr, 16);
+    };
+    uint32_t count = hex_byte(1);
+    uint32_t offset = (hex_byte(3) << 8) | hex_byte(5);
+    uint32_t type = hex_byte(7);
+    switch (type) {
+    case 0: { // data
+      std::vector<Byte> data(count);
+      for (uint32_t i = 0; i < count; ++i) {
+        data[i] = hex_byte(9 + i * 2);
+      }
+      this->write(data.data(), base_addr + offset, count);
+    } break;
+    case 1: // end of file
+      return true;
+    case 2: // extended segment address
+      base_addr = ((hex_byte(9) << 8) | hex_byte(11)) << 4;
+      break;
+    case 4: // extended linear address
+      base_addr = uint64_t((hex_byte(9) << 8) | hex_byte(11)) << 16;
+      break;
+    default:
+      break;
+    }
+  }
+  return true;
+}
+
+const Byte* ProgramImage::page(uint64_t page_index) const {
+  auto it = pages_.find(page_index);
+  if (it == pages_.end())
+    return nullptr;
+  return it->second;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ImageCache& ImageCache::instance() {
+  static ImageCache cache;
+  return cache;
+}
+
+ProgramImage::Ptr ImageCache::get(const char* filename, uint32_t page_size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::string key(filename);
+  auto it = images_.find(key);
+  if (it != images_.end()) {
+    assert(it->second->page_size() == page_size);
+    return it->second;
+  }
+
+  auto image = std::make_shared<ProgramImage>(page_size);
+  std::string program_ext(fileExtension(filename));
+  bool loaded = false;
+  if (program_ext == "bin") {
+    loaded = image->loadBinImage(filename, STARTUP_ADDR);
+  } else if (program_ext == "hex") {
+    loaded = image->loadHexImage(filename);
+  } else {
+    std::cout << "*** error: only *.bin or *.hex images supported." << std::endl;
+  }
+  if (!loaded)
+    return nullptr;
+
+  images_[key] = image;
+  return image;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ImageRAM::ImageRAM(ProgramImage::Ptr image)
+  : image_(image)
+  , page_size_(image->page_size())
+{}
+
+ImageRAM::~ImageRAM() {}
+
+uint64_t ImageRAM::size() const {
+  return uint64_t(1) << MEM_ADDR_WIDTH;
+}
+
+Byte* ImageRAM::writable_page(uint64_t page_index) {
+  auto& page = private_pages_[page_index];
+  if (page.empty()) {
+    // first write to this page, duplicate it
+    auto shared = image_->page(page_index);
+    if (shared) {
+      page.assign(shared, shared + page_size_);
+    } else {
+      page.resize(page_size_, 0);
+    }
+  }
+  return page.data();
+}
+
+void ImageRAM::read(void* data, uint64_t addr, uint64_t size) {
+  auto dst = (Byte*)data;
+  while (size != 0) {
+    uint64_t page_index = addr / page_size_;
+    uint64_t offset = addr % page_size_;
+    uint64_t chunk = std::min<uint64_t>(size, page_size_ - offset);
+    const Byte* page = nullptr;
+    auto it = private_pages_.find(page_index);
+    if (it != private_pages_.end()) {
+      page = it->second.data();
+    } else {
+      page = image_->page(page_index);
+    }
+    if (page) {
+      memcpy(dst, page + offset, chunk);
+    } else {
+      memset(dst, 0, chunk);
+    }
+    dst  += chunk;
+    addr += chunk;
+    size -= chunk;
+  }
+}
+
+void ImageRAM::write(const void* data, uint64_t addr, uint64_t size) {
+  auto src = (const Byte*)data;
+  while (size != 0) {
+    uint64_t page_index = addr / page_size_;
+    uint64_t offset = addr % page_size_;
+    uint64_t chunk = std::min<uint64_t>(size, page_size_ - offset);
+    memcpy(this->writable_page(page_index) + offset, src, chunk);
+    src  += chunk;
+    addr += chunk;
+    size -= chunk;
+  }
+}
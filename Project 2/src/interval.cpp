@@ -0,0 +1,56 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include "interval.h"
+
+using namespace tinyrv;
+
+IntervalWriter::IntervalWriter(const char* filename, uint64_t period, bool by_instrs)
+  : ofs_(filename)
+  , period_(period)
+  , by_instrs_(by_instrs)
+  , fields_(0) {
+  if (!ofs_) {
+    std::cout << "Error: cannot open interval stats file " << filename << std::endl;
+    std::abort();
+  }
+  if (period_ == 0) {
+    std::cout << "Error: invalid stats interval" << std::endl;
+    std::abort();
+  }
+}
+
+IntervalWriter::~IntervalWriter() {
+  ofs_.flush();
+}
+
+void IntervalWriter::begin() {
+  ofs_ << "{";
+  fields_ = 0;
+}
+
+void IntervalWriter::field(const char* key, uint64_t value) {
+  ofs_ << (fields_++ ? ", " : "") << "\"" << key << "\": " << value;
+}
+
+void IntervalWriter::field(const char* key, double value) {
+  ofs_ << (fields_++ ? ", " : "") << "\"" << key << "\": "
+       << std::fixed << std::setprecision(4) << value << std::defaultfloat;
+}
+
+void IntervalWriter::end() {
+  ofs_ << "}" << std::endl;
+}
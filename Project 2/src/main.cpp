@@ -18,26 +18,112 @@
 #include <fstream>
 #include <stdlib.h>
 #include <unistd.h>
+#include <getopt.h>
 #include <sys/stat.h>
 #include <util.h>
 #include "processor.h"
 #include "mem.h"
 #include "core.h"
+#include "image.h"
 
 using namespace tinyrv;
 
 static void show_usage() {
-   std::cout << "Usage: [-g|gg: gshare] [-s: stats] [-h: help] <program>" << std::endl;
+   std::cout << "Usage: [-g|gg: gshare] [-b|--bpred=<plugin.so[:args]>: predictor plugin] [-l <n>: lockstep lanes] [-d <file>: per-lane input, %d is the lane] [-r <n>: repeat runs] [-t <file>: binary trace] [-k <file>: pipeline view] [-w <begin>:<end>: view cycles] [-a <file>: per-PC profile] [-f <file>: flame graph] [-m <file>: symbol map] [-o: data region profile] [-c <file>: access patterns] [-x <file>: predictor aliasing] [-j <file>: interval stats] [-i <n>[i]: interval cycles or instrs] [-p: host profile] [-e <file>: live stats page] [-u <n>: live stats cycles] [-s: stats] [-h: help] <program>" << std::endl;
 }
 
 bool showStats = false;
 const char* program = nullptr;
+uint32_t numRuns = 1;
+const char* traceFile = nullptr;
+const char* konataFile = nullptr;
+uint64_t konataBegin = 0;
+uint64_t konataEnd = UINT64_MAX;
+const char* profileFile = nullptr;
+const char* flameFile = nullptr;
+const char* symbolFile = nullptr;
+const char* intervalFile = nullptr;
+uint64_t intervalPeriod = 100000;
+bool intervalByInstrs = false;
+bool hostProfile = false;
+const char* statPageFile = nullptr;
+uint64_t statPagePeriod = 10000;
+bool memProfile = false;
+const char* patternFile = nullptr;
+const char* aliasFile = nullptr;
+uint32_t numLanes = 0;
+const char* laneDataFile = nullptr;
 int gshare_enabled = 0;
+const char* bpred_plugin = nullptr;
 
 static void parse_args(int argc, char **argv) {
+  static const struct option long_options[] = {
+    {"bpred", required_argument, nullptr, 'b'},
+    {nullptr, 0, nullptr, 0}
+  };
   int c;
-  while ((c = getopt(argc, argv, "gsh?")) != -1) {
+  while ((c = getopt_long(argc, argv, "gb:l:d:r:t:k:w:a:f:m:j:i:pe:u:oc:x:sh?", long_options, nullptr)) != -1) {
     switch (c) {
+    case 'b':
+      bpred_plugin = optarg;
+      break;
+    case 'l':
+      numLanes = atoi(optarg);
+      break;
+    case 'd':
+      laneDataFile = optarg;
+      break;
+    case 'r':
+      numRuns = atoi(optarg);
+      break;
+    case 't':
+      traceFile = optarg;
+      break;
+    case 'k':
+      konataFile = optarg;
+      break;
+    case 'w': {
+      char* sep = nullptr;
+      konataBegin = strtoull(optarg, &sep, 0);
+      if (sep && *sep == ':') {
+        konataEnd = strtoull(sep + 1, nullptr, 0);
+      }
+    } break;
+    case 'a':
+      profileFile = optarg;
+      break;
+    case 'f':
+      flameFile = optarg;
+      break;
+    case 'm':
+      symbolFile = optarg;
+      break;
+    case 'j':
+      intervalFile = optarg;
+      break;
+    case 'i': {
+      char* suffix = nullptr;
+      intervalPeriod = strtoull(optarg, &suffix, 0);
+      intervalByInstrs = (suffix && *suffix == 'i');
+    } break;
+    case 'p':
+      hostProfile = true;
+      break;
+    case 'e':
+      statPageFile = optarg;
+      break;
+    case 'u':
+      statPagePeriod = strtoull(optarg, nullptr, 0);
+      break;
+    case 'o':
+      memProfile = true;
+      break;
+    case 'c':
+      patternFile = optarg;
+      break;
+    case 'x':
+      aliasFile = optarg;
+      break;
     case 's':
       showStats = true;
       break;
@@ -66,6 +152,19 @@ static void parse_args(int argc, char **argv) {
     show_usage();
     exit(-1);
   }
+
+  if (numLanes != 0) {
+    // the lockstep engine is purely functional, none of the pipeline options apply
+    if (numRuns != 1 || traceFile || konataFile || profileFile || flameFile
+     || intervalFile || hostProfile || statPageFile || memProfile || patternFile
+     || aliasFile || gshare_enabled || bpred_plugin) {
+      std::cout << "Error: -l only supports -d and -s" << std::endl;
+      exit(-1);
+    }
+  } else if (laneDataFile) {
+    std::cout << "Error: -d requires -l" << std::endl;
+    exit(-1);
+  }
 }
 
 int main(int argc, char **argv) {
@@ -73,40 +172,147 @@ int main(int argc, char **argv) {
 
   parse_args(argc, argv);
 
-  {
-    // create memory module
-    RAM ram(RAM_PAGE_SIZE);
-
-    // load program
-    {
-      std::string program_ext(fileExtension(program));
-      if (program_ext == "bin") {
-        ram.loadBinImage(program, STARTUP_ADDR);
-      } else if (program_ext == "hex") {
-        ram.loadHexImage(program);
-      } else {
-        std::cout << "*** error: only *.bin or *.hex images supported." << std::endl;
-        return -1;
+  if (numLanes != 0) {
+    // share a single copy of the program image across all lanes
+    auto image = ImageCache::instance().get(program, RAM_PAGE_SIZE);
+    if (!image)
+      return -1;
+
+    std::vector<std::shared_ptr<ImageRAM>> rams;
+    std::vector<MemDevice*> mems;
+    for (uint32_t l = 0; l < numLanes; ++l) {
+      rams.push_back(std::make_shared<ImageRAM>(image));
+      mems.push_back(rams.back().get());
+    }
+
+    // overlay each lane's own input data
+    if (laneDataFile) {
+      for (uint32_t l = 0; l < numLanes; ++l) {
+        std::string filename(laneDataFile);
+        auto pos = filename.find("%d");
+        if (pos != std::string::npos) {
+          filename.replace(pos, 2, std::to_string(l));
+        }
+        std::ifstream ifs(filename, std::ios::binary);
+        if (!ifs) {
+          std::cout << "Error: cannot open lane input " << filename << std::endl;
+          return -1;
+        }
+        std::vector<char> data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        rams[l]->write(data.data(), LANE_DATA_ADDR, data.size());
       }
     }
 
+    // run functional simulation of all lanes in lockstep
+    Processor processor;
+    auto exitcodes = processor.run_lanes(mems, true);
+    exitcode = 0;
+    for (uint32_t l = 0; l < numLanes; ++l) {
+      std::istringstream output(processor.lane_output(l));
+      std::string line;
+      while (std::getline(output, line)) {
+        std::cout << "[lane " << l << "] " << line << std::endl;
+      }
+    }
+    for (uint32_t l = 0; l < numLanes; ++l) {
+      if (exitcodes[l] != 0) {
+        std::cout << "*** FAILED: lane=" << l << ", exitcode=" << exitcodes[l] << std::endl;
+        exitcode = exitcodes[l];
+      }
+    }
+    if (exitcode == 0) {
+      std::cout << "PASSED!" << std::endl;
+    }
+
+    // show performance stats
+    if (showStats) {
+      processor.showStats();
+    }
+    return exitcode;
+  }
+
+  {
+    // copy-on-write view over the program image, whose pristine pages are
+    // shared with every other simulation of the same binary
+    auto image = ImageCache::instance().get(program, RAM_PAGE_SIZE);
+    if (!image)
+      return -1;
+    ImageRAM ram(image);
+
     // create processor
     Processor processor;
 
     // attach memory module
     processor.attach_ram(&ram);
 
-    // run simulation
-    exitcode = processor.run(true);
-    if (exitcode != 0) {
-      std::cout << "*** FAILED: exitcode=" << exitcode << std::endl;
-    } else {
-      std::cout << "PASSED!" << std::endl;
+    // enable binary tracing
+    if (traceFile) {
+      processor.enable_trace(traceFile);
     }
 
-    // show performance stats
-    if (showStats) {
-      processor.showStats();
+    // enable pipeline viewer trace
+    if (konataFile) {
+      processor.enable_konata(konataFile, konataBegin, konataEnd);
+    }
+
+    // enable per-PC cycle attribution
+    if (profileFile) {
+      processor.enable_pc_profile(profileFile);
+    }
+
+    // enable guest function profiling
+    if (flameFile) {
+      processor.enable_call_profile(flameFile, symbolFile);
+    }
+
+    // enable interval statistics
+    if (intervalFile) {
+      processor.enable_interval_stats(intervalFile, intervalPeriod, intervalByInstrs);
+    }
+
+    // enable simulator self-profiling
+    if (hostProfile) {
+      processor.enable_host_profile();
+    }
+
+    // enable data region attribution
+    if (memProfile) {
+      processor.enable_mem_profile(symbolFile);
+    }
+
+    // enable load/store address pattern classification
+    if (patternFile) {
+      processor.enable_pattern_profile(patternFile);
+    }
+
+    // enable branch predictor aliasing analysis
+    if (aliasFile) {
+      processor.enable_bpred_analyzer(aliasFile);
+    }
+
+    // enable live statistics page
+    if (statPageFile) {
+      processor.enable_stat_page(statPageFile, statPagePeriod);
+    }
+
+    for (uint32_t run = 0; run < numRuns; ++run) {
+      // restore the pages written by the previous run
+      if (run != 0) {
+        processor.reset_to_image();
+      }
+
+      // run simulation
+      exitcode = processor.run(true);
+      if (exitcode != 0) {
+        std::cout << "*** FAILED: exitcode=" << exitcode << std::endl;
+      } else {
+        std::cout << "PASSED!" << std::endl;
+      }
+
+      // show performance stats
+      if (showStats) {
+        processor.showStats();
+      }
     }
   }
 
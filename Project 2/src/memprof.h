@@ -0,0 +1,68 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+namespace tinyrv {
+
+// Data memory accesses attributed to address regions: named globals from an
+// "nm" symbol map (sized by "nm -S" or by the next symbol), the heap between
+// the "_end" symbol and the stack pointer, the live stack, and IO.
+class MemProfiler {
+public:
+  MemProfiler(const char* symfile);
+
+  // records an access and returns the region it falls in
+  int access(uint32_t addr, uint32_t size, bool is_write, uint32_t sp);
+
+  // charges memory stall cycles to a region
+  void stall(int region, uint64_t cycles);
+
+  void print(std::ostream& os) const;
+
+private:
+
+  struct region_t {
+    std::string name;
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t bytes;
+    uint64_t stall_cycles;
+  };
+
+  struct range_t {
+    uint32_t end;
+    int      region;
+  };
+
+  int add_region(const std::string& name);
+
+  void load_symbols(const char* symfile);
+
+  std::vector<region_t> regions_;
+  std::map<std::string, int> names_;
+  std::map<uint32_t, range_t> ranges_; // keyed by start address
+  uint32_t heap_start_;
+  int stack_;
+  int heap_;
+  int io_;
+  int other_;
+};
+
+}
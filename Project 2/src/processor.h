@@ -14,10 +14,13 @@
 #pragma once
 
 #include <stdint.h>
+#include <vector>
+#include <string>
 
 namespace tinyrv {
 
-class RAM;
+class MemDevice;
+class CoreObserver;
 class ProcessorImpl;
 
 class Processor {
@@ -25,10 +28,45 @@ public:
   Processor();
   ~Processor();
 
-  void attach_ram(RAM* mem);
+  void attach_ram(MemDevice* mem);
 
   int run(bool riscv_test);
 
+  void reset_to_image();
+
+  bool run_for(uint64_t cycles);
+
+  bool step();
+
+  int exitcode(bool riscv_test) const;
+
+  void set_observer(CoreObserver* observer);
+
+  void enable_trace(const char* filename);
+
+  void enable_konata(const char* filename, uint64_t begin_cycle, uint64_t end_cycle);
+
+  void enable_pc_profile(const char* filename);
+
+  void enable_call_profile(const char* filename, const char* symfile);
+
+  void enable_interval_stats(const char* filename, uint64_t period, bool by_instrs);
+
+  void enable_host_profile();
+
+  void enable_stat_page(const char* filename, uint64_t period);
+
+  void enable_mem_profile(const char* symfile);
+
+  void enable_pattern_profile(const char* filename);
+
+  void enable_bpred_analyzer(const char* filename);
+
+  std::vector<int> run_lanes(const std::vector<MemDevice*>& mems, bool riscv_test);
+
+  // console output a lane printed during run_lanes()
+  const std::string& lane_output(uint32_t lane) const;
+
   void showStats();
 
 private:
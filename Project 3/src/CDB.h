@@ -48,6 +48,10 @@ public:
     empty_ = true;
   }
 
+  void reset() {
+    empty_ = true;
+  }
+
 private:
   bool   empty_;
   data_t data_;
@@ -135,6 +135,7 @@ void ALU::do_execute() {
 void BRU::do_execute() {
   auto br_op = instr_->getBrOp();
   auto br_taken = execute_br_op(br_op, rs1_value_, rs2_value_);
+  instr_->setBrTaken(br_taken);
   if (br_taken) {
     auto br_target = execute_alu_op(*instr_, rs1_value_, rs2_value_);
     core_->PC_ = br_target;
@@ -143,19 +144,31 @@ void BRU::do_execute() {
     }
   }
   DT(2, "Branch: " << (br_taken ? "taken" : "not-taken") << ", target=0x" << std::hex << core_->PC_ << std::dec << " (#" << instr_->getId() << ")");
+  OBSERVE(core_->observer_, BRANCH, on_branch(instr_->getId(), instr_->getPC(), br_taken, core_->PC_, false));
+  BT(core_->tracer_, core_->perf_stats_.cycles, Execute, Branch, instr_->getId(), instr_->getPC(), br_taken, core_->PC_);
   core_->fetch_stalled_->write(false); // release fetch stage
+  core_->branch_issued_ = false; // refill cycles from here on are front-end time
 }
 
 void LSU::do_execute() {
   auto exe_flags = instr_->getExeFlags();
   auto func3 = instr_->getFunc3();
 
+  ++core_->hpm_events_[VX_HPM_EVENT_LSU_OPS];
+
   if (exe_flags.is_load) {
     uint64_t mem_addr = execute_alu_op(*instr_, rs1_value_, rs2_value_);
     uint32_t data_bytes = 1 << (func3 & 0x3);
     uint32_t data_width = 8 * data_bytes;
     uint32_t read_data = 0;
     core_->dmem_read(&read_data, mem_addr, data_bytes);
+    if (core_->pattern_profile_) {
+      core_->pattern_profile_->access(instr_->getPC(), mem_addr, read_data, true);
+    }
+    if (core_->mem_profile_) {
+      core_->mem_regions_[instr_->getId()] = core_->mem_profile_->access(mem_addr, data_bytes, false, this->stack_pointer());
+    }
+    BT(core_->tracer_, core_->perf_stats_.cycles, Execute, MemRead, instr_->getId(), instr_->getPC(), data_bytes, (mem_addr | (uint64_t(read_data) << 32)));
     switch (func3) {
     case 0: // RV32I: LB
     case 1: // RV32I: LH
@@ -179,6 +192,13 @@ void LSU::do_execute() {
     case 1:
     case 2:
       core_->dmem_write(&rs2_value_, mem_addr, data_bytes);
+      if (core_->pattern_profile_) {
+        core_->pattern_profile_->access(instr_->getPC(), mem_addr, rs2_value_, false);
+      }
+      if (core_->mem_profile_) {
+        core_->mem_regions_[instr_->getId()] = core_->mem_profile_->access(mem_addr, data_bytes, true, this->stack_pointer());
+      }
+      BT(core_->tracer_, core_->perf_stats_.cycles, Execute, MemWrite, instr_->getId(), instr_->getPC(), data_bytes, (mem_addr | (uint64_t(rs2_value_) << 32)));
       break;
     default:
       std::abort();
@@ -186,6 +206,18 @@ void LSU::do_execute() {
   }
 }
 
+// sp as this access sees it: its own base operand when it addresses off sp,
+// otherwise the x2 producer captured at issue once it has broadcast, since
+// the committed register file lags behind prologue/epilogue adjustments
+uint32_t LSU::stack_pointer() const {
+  if (instr_->getRs1() == 2)
+    return rs1_value_;
+  auto& entry = core_->RS_.get_entry(this->get_output().rs_index);
+  if (entry.sp_index == -1)
+    return entry.sp_data;
+  return core_->reg_file_.at(2);
+}
+
 void SFU::do_execute() {
   auto csr_data = core_->get_csr(instr_->getImm());
   auto rd_data = execute_alu_op(*instr_, rs1_value_, csr_data);
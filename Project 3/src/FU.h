@@ -138,6 +138,8 @@ public:
   void do_execute();
 
 private:
+  uint32_t stack_pointer() const;
+
   Core* core_;
 };
 
@@ -26,6 +26,12 @@ public:
 
   ~RegisterAliasTable() {}
 
+  void reset() {
+    for (auto& entry : store_) {
+      entry = {false, 0};
+    }
+  }
+
   bool exists(int index) const {
     return store_.at(index).first;
   }
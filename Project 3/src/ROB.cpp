@@ -36,6 +36,15 @@ ReorderBuffer::~ReorderBuffer() {
   //--
 }
 
+void ReorderBuffer::reset() {
+  for (auto& entry : store_) {
+    entry = {false, false, 0, nullptr};
+  }
+  head_index_ = 0;
+  tail_index_ = 0;
+  count_ = 0;
+}
+
 int ReorderBuffer::allocate(Instr::Ptr instr) {
   assert(!this->full());
   int index = tail_index_;
@@ -73,11 +82,13 @@ int ReorderBuffer::pop() {
   return head_index_;
 }
 
-void ReorderBuffer::dump() {
+void ReorderBuffer::dump(TraceWriter* tracer, uint64_t cycle) {
+  __unused (cycle);
   for (int i = 0; i < (int)store_.size(); ++i) {
     auto& entry = store_[i];
     if (entry.valid) {
-      DT(4, "ROB[" << i << "] ready=" << entry.ready << ", head=" << (i == head_index_) << " (#" << entry.instr->getId() << ")");
+      // payload: ready[0], head[1]
+      BT(tracer, cycle, Commit, ROBState, entry.instr->getId(), entry.instr->getPC(), i, (entry.ready | ((i == head_index_) << 1)));
     }
   }
 }
\ No newline at end of file
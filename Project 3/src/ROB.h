@@ -16,6 +16,7 @@
 #include <vector>
 #include "instr.h"
 #include "CDB.h"
+#include "bintrace.h"
 
 namespace tinyrv {
 
@@ -33,6 +34,8 @@ public:
 
   ~ReorderBuffer();
 
+  void reset();
+
   bool full() const {
     return count_ == store_.size();
   }
@@ -41,6 +44,10 @@ public:
     return count_ == 0;
   }
 
+  uint32_t count() const {
+    return count_;
+  }
+
   int allocate(Instr::Ptr instr);
 
   int pop();
@@ -59,7 +66,7 @@ public:
     return store_.at(index);
   }
 
-  void dump();
+  void dump(TraceWriter* tracer, uint64_t cycle);
 
 private:
 
@@ -32,6 +32,17 @@ ReservationStation::ReservationStation(uint32_t size)
 
 ReservationStation::~ReservationStation() {}
 
+void ReservationStation::reset() {
+  for (uint32_t i = 0; i < store_.size(); ++i) {
+    store_[i].valid = false;
+    store_[i].running = false;
+    store_[i].instr = nullptr;
+    indices_[i] = i;
+  }
+  next_index_ = 0;
+  lsu_barrier_.reset();
+}
+
 int ReservationStation::issue(int rob_index, int rs1_index, int rs2_index, uint32_t rs1_data, uint32_t rs2_data, Instr::Ptr instr) {
     assert(!this->full());
     int index = indices_[next_index_++];
@@ -39,7 +50,7 @@ int ReservationStation::issue(int rob_index, int rs1_index, int rs2_index, uint3
     if (instr->getFUType() == FUType::LSU) {
       barrier_id = lsu_barrier_.tick();
     }
-    store_[index] = {true, false, rob_index, rs1_index, rs2_index, rs1_data, rs2_data, barrier_id, instr};
+    store_[index] = {true, false, rob_index, rs1_index, rs2_index, rs1_data, rs2_data, barrier_id, instr, -1, 0};
     assert(index != rs1_index);
     assert(index != rs2_index);
     return index;
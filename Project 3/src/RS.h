@@ -15,6 +15,7 @@
 #include <vector>
 #include "instr.h"
 #include "CDB.h"
+#include "bintrace.h"
 
 namespace tinyrv {
 
@@ -31,6 +32,8 @@ public:
     uint32_t rs2_data; // rs2 data
     uint32_t barrier_id; // barrier id to enforce ordering fo LSU instructions
     Instr::Ptr instr; // instruction data
+    int sp_index;     // RS producing the sp an LSU access was issued after (-1 indicates sp_data holds it)
+    uint32_t sp_data; // sp data, for classifying stack accesses
 
     bool operands_ready() const {
       return rs1_index == -1 && rs2_index == -1;
@@ -49,6 +52,11 @@ public:
         rs2_data = data.result;
         rs2_index = -1; // Now rs2 is ready
       }
+      // sp is tracked for profiling only, the access never waits for it
+      if (sp_index != -1 && sp_index == data.rs_index) {
+        sp_data = data.result;
+        sp_index = -1;
+      }
     }
   };
 
@@ -56,6 +64,8 @@ public:
 
   ~ReservationStation();
 
+  void reset();
+
   bool operands_ready(uint32_t index) const {
     // are all operands ready?
     // TODO:
@@ -84,15 +94,22 @@ public:
     return (next_index_ == 0);
   }
 
+  uint32_t count() const {
+    return next_index_;
+  }
+
   uint32_t size() const {
     return store_.size();
   }
 
-  void dump() {
+  void dump(TraceWriter* tracer, uint64_t cycle) {
+    __unused (cycle);
     for (uint32_t i = 0; i < store_.size(); ++i) {
       auto& entry = store_[i];
       if (entry.valid) {
-        DT(4, "RS[" << i << "] rob=" << entry.rob_index << ", running=" << entry.running << ", rs1=" << entry.rs1_index << ", rs2=" << entry.rs2_index << " (#" << entry.instr->getId() << ")");
+        // payload: rob[7:0], running[8], rs1[23:16], rs2[31:24]
+        BT(tracer, cycle, Issue, RSState, entry.instr->getId(), entry.instr->getPC(), i,
+           ((entry.rob_index & 0xff) | (entry.running << 8) | ((entry.rs1_index & 0xff) << 16) | ((uint32_t)(entry.rs2_index & 0xff) << 24)));
       }
     }
   }
@@ -13,11 +13,32 @@
 // limitations under the License.
 
 #include <vector>
+#include <algorithm>
 
 namespace tinyrv {
 
 // register status table
 // track the mapping from ROB index to RS index
-typedef std::vector<int> RegisterStatusTable;
+class RegisterStatusTable {
+public:
+  RegisterStatusTable(uint32_t size) : store_(size, 0) {}
+
+  ~RegisterStatusTable() {}
+
+  int& operator[](int index) {
+    return store_[index];
+  }
+
+  int operator[](int index) const {
+    return store_[index];
+  }
+
+  void reset() {
+    std::fill(store_.begin(), store_.end(), 0);
+  }
+
+private:
+  std::vector<int> store_;
+};
 
 }
\ No newline at end of file
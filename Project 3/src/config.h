@@ -30,10 +30,39 @@
 
 #define NUM_REGS 32
 
+// cycles between occupancy interval reports (0 disables them)
+#ifndef OCCUPANCY_INTERVAL
+#define OCCUPANCY_INTERVAL 0
+#endif
+
+// legacy mcycle reads: report the stall-free estimate (instrs - 1) + 5 and
+// execute CSR instructions without waiting for the ROB head
+#ifndef IDEAL_MCYCLE
+#define IDEAL_MCYCLE 0
+#endif
+
+// cycles without a commit before the watchdog reports a deadlock and stops
+// the run with WATCHDOG_EXIT_CODE (0 disables it)
+#ifndef WATCHDOG_CYCLES
+#define WATCHDOG_CYCLES 100000
+#endif
+
+// distinct from the codes wrappers report on their own: timeout(1) and
+// the shell use 124-127 and 128+N for signals, and errors here exit -1
+#ifndef WATCHDOG_EXIT_CODE
+#define WATCHDOG_EXIT_CODE 99
+#endif
+
 #ifndef DEBUG_LEVEL
 #define DEBUG_LEVEL 3
 #endif
 
+// observer hooks compiled into the core, a mask of the EVENT_HOOK_* bits
+// in observer.h (e.g. -DEVENT_HOOKS=EVENT_HOOK_COMMIT), 0 compiles none
+#ifndef EVENT_HOOKS
+#define EVENT_HOOKS 0
+#endif
+
 #ifndef RAM_PAGE_SIZE
 #define RAM_PAGE_SIZE 4096
 #endif
@@ -91,12 +120,24 @@
 
 #define VX_CSR_MEPC                     0x341
 
+#define VX_CSR_MHPMEVENT3               0x323
+
 #define VX_CSR_MNSTATUS                 0x744
 
+// Custom CSRs ////////////////////////////////////////////////////////////////
+
+// region of interest: write a non-zero id to start a region, 0 to stop it
+#define VX_CSR_ROI                      0x7C0
+// guest address of a NUL-terminated name for the next region start
+#define VX_CSR_ROI_NAME                 0x7C1
+
 #define VX_CSR_MPM_BASE                 0xB00
 #define VX_CSR_MPM_BASE_H               0xB80
 #define VX_CSR_MPM_USER                 0xB03
 #define VX_CSR_MPM_USER_H               0xB83
+// read-only user-mode aliases hpmcounter3..31 of mhpmcounter3..31
+#define VX_CSR_HPM_USER                 0xC03
+#define VX_CSR_HPM_USER_H               0xC83
 
 #define VX_CSR_MCYCLE                   0xB00
 #define VX_CSR_MCYCLE_H                 0xB80
@@ -105,6 +146,20 @@
 #define VX_CSR_MINSTRET                 0xB02
 #define VX_CSR_MINSTRET_H               0xB82
 
+// mhpmcounter3..31 and their mhpmevent3..31 selectors
+#define VX_HPM_COUNTERS                 29
+
+// mhpmevent selectors; events a core does not model always read 0
+#define VX_HPM_EVENT_NONE               0
+#define VX_HPM_EVENT_BPRED_MISS         1   // branch mispredictions
+#define VX_HPM_EVENT_LOAD_USE           2   // load-use stall cycles
+#define VX_HPM_EVENT_ROB_FULL           3   // issue stall cycles on a full ROB
+#define VX_HPM_EVENT_RS_FULL            4   // issue stall cycles on full reservation stations
+#define VX_HPM_EVENT_LSU_OPS            5   // executed loads and stores
+#define VX_HPM_EVENT_CDB_CONFLICT       6   // cycles a completed result waits for the CDB
+#define VX_HPM_EVENT_FLUSH              7   // pipeline flushes
+#define VX_HPM_EVENT_COUNT              8
+
 #define VX_CSR_MVENDORID                0xF11
 #define VX_CSR_MARCHID                  0xF12
 #define VX_CSR_MIMPID                   0xF13
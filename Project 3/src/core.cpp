@@ -12,6 +12,7 @@
 // limitations under the License.
 
 #include <iostream>
+#include <algorithm>
 #include <iomanip>
 #include <string.h>
 #include <assert.h>
@@ -25,6 +26,10 @@
 
 using namespace tinyrv;
 
+static const char* stall_cause_names[] = {"alu", "bru", "lsu", "sfu", "cdb", "rs_full", "rob_full", "branch", "frontend"};
+
+static const char* hpm_event_names[] = {"none", "bpred_miss", "load_use", "rob_full", "rs_full", "lsu_ops", "cdb_conflict", "flush"};
+
 Core::Core(const SimContext& ctx, uint32_t core_id, ProcessorImpl* processor)
     : SimObject(ctx, "core")
     , core_id_(core_id)
@@ -38,6 +43,15 @@ Core::Core(const SimContext& ctx, uint32_t core_id, ProcessorImpl* processor)
     , RS_(NUM_RSS) // reservation station size set to NUM_RSS
     , RST_(NUM_REGS) // Register Status table set to NUM_REGS
     , FUs_(NUM_FUS) // Number of functional units
+    , observer_(nullptr)
+    , tracer_(nullptr)
+    , konata_(nullptr)
+    , pc_profile_(nullptr)
+    , call_profile_(nullptr)
+    , interval_(nullptr)
+    , stat_page_(nullptr)
+    , mem_profile_(nullptr)
+    , pattern_profile_(nullptr)
 {
   // create functional units
   FUs_.at((int)FUType::ALU) = std::make_shared<ALU>(this);
@@ -57,26 +71,85 @@ void Core::reset() {
   decode_queue_->reset();
   issue_queue_->reset();
 
+  // drop whatever was still in flight when the previous run exited
+  ROB_.reset();
+  RS_.reset();
+  RAT_.reset();
+  RST_.reset();
+  CDB_.reset();
+  for (auto& fu : FUs_) {
+    fu->clear();
+  }
+
+  cout_buf_.str("");
+  cout_buf_.clear();
+
   PC_ = STARTUP_ADDR;
 
+  std::fill(reg_file_.begin(), reg_file_.end(), 0);
+
   uuid_ctr_ = 0;
 
   fetched_instrs_ = 0;
   perf_stats_ = PerfStats();
+  interval_base_ = PerfStats();
+  regions_.clear();
+  region_.clear();
+  region_name_.clear();
+  region_id_ = 0;
+  hpm_events_.fill(0);
+  mhpmevent_.fill(VX_HPM_EVENT_NONE);
+  mhpmcounter_base_.fill(0);
+  occupancy_.reset();
+  occupancy_base_ = occupancy_.sums();
+  latency_.reset();
+  instr_mix_.reset();
+  branch_issued_ = false;
 
   fetch_stalled_->reset();
   exited_ = false;
+  last_commit_cycle_ = 0;
+  mem_regions_.clear();
+  mem_stall_cycles_ = 0;
+  wedged_ = false;
 }
 
 void Core::tick() {
-  this->commit();
-  this->writeback();
-  this->execute();
-  this->issue();
-  this->decode();
-  this->fetch();
+  HostScope host_scope(HostPhase::Core);
+
+  HOST_PROFILE(Commit, this->commit());
+  HOST_PROFILE(Writeback, this->writeback());
+  HOST_PROFILE(Execute, this->execute());
+  HOST_PROFILE(Issue, this->issue());
+  HOST_PROFILE(Decode, this->decode());
+  HOST_PROFILE(Fetch, this->fetch());
+
+  this->sample_occupancy();
+
+  if (call_profile_) {
+    HOST_PROFILE(Trace, call_profile_->tick());
+  }
+
+  // forward-progress watchdog
+  if (WATCHDOG_CYCLES != 0 && !exited_ && !wedged_
+   && (perf_stats_.cycles - last_commit_cycle_) >= WATCHDOG_CYCLES) {
+    this->watchdog_report(std::cout);
+    wedged_ = true;
+  }
 
   ++perf_stats_.cycles;
+
+  // periodic snapshot, plus a final partial one at exit
+  if (interval_
+   && (interval_->due(perf_stats_.cycles - interval_base_.cycles, perf_stats_.instrs - interval_base_.instrs)
+    || (exited_ && perf_stats_.instrs != interval_base_.instrs))) {
+    HOST_PROFILE(Trace, this->write_interval());
+  }
+
+  // live statistics, plus a final update at exit or watchdog timeout
+  if (stat_page_ && (stat_page_->due(perf_stats_.cycles) || exited_ || wedged_)) {
+    HOST_PROFILE(Trace, this->write_stat_page());
+  }
   DPN(2, std::flush);
 }
 
@@ -89,12 +162,18 @@ void Core::fetch() {
 
   // fetch next instruction from memory at PC address
   uint32_t instr_code = 0;
-  mmu_.read(&instr_code, PC_, sizeof(uint32_t), 0);
+  HOST_PROFILE(MemAccess, mmu_.read(&instr_code, PC_, sizeof(uint32_t), 0));
 
   DT(2, "Fetch: instr=0x" << instr_code << ", PC=0x" << std::hex << PC_ << std::dec << " (#" << uuid << ")");
+  OBSERVE(observer_, FETCH, on_fetch(uuid, PC_, instr_code));
+  BT(tracer_, perf_stats_.cycles, Fetch, Stage, uuid, PC_, 0, instr_code);
+  if (konata_) {
+    konata_->fetch(perf_stats_.cycles, uuid, PC_);
+    konata_->stage(perf_stats_.cycles, uuid, "F");
+  }
 
   // move instruction data to next stage
-  decode_queue_->push({instr_code, PC_, uuid});
+  decode_queue_->push({instr_code, PC_, uuid, perf_stats_.cycles});
 
   // advance program counter
   PC_ += 4;
@@ -114,8 +193,17 @@ void Core::decode() {
 
   // instruction decode
   auto instr = this->decode(id_data.instr_code, id_data.PC, id_data.uuid);
+  instr->timing().fetch = id_data.cycle;
 
   DT(2, "Decode: " << *instr);
+  OBSERVE(observer_, DECODE, on_decode(id_data.uuid, id_data.PC, *instr));
+  BT(tracer_, perf_stats_.cycles, Decode, Stage, id_data.uuid, id_data.PC, 0, id_data.instr_code);
+  if (konata_) {
+    std::stringstream ss;
+    ss << *instr;
+    konata_->stage(perf_stats_.cycles, id_data.uuid, "D");
+    konata_->label(perf_stats_.cycles, id_data.uuid, ss.str());
+  }
 
   // release fetch stage if not a branch
   // keep fetch stage locked if exiting program
@@ -130,27 +218,34 @@ void Core::decode() {
 }
 
 void Core::dmem_read(void *data, uint64_t addr, uint32_t size) {
+  HostScope host_scope(HostPhase::MemAccess);
   auto type = get_addr_type(addr);
   __unused (type);
   mmu_.read(data, addr, size, 0);
+  OBSERVE(observer_, DMEM_READ, on_dmem_read(addr, data, size));
   DT(2, "Mem Read: addr=0x" << std::hex << addr << ", data=0x" << ByteStream(data, size) << " (size=" << size << ", type=" << type << ")");
 }
 
 void Core::dmem_write(const void* data, uint64_t addr, uint32_t size) {
+  HostScope host_scope(HostPhase::MemAccess);
   auto type = get_addr_type(addr);
   __unused (type);
   if (addr >= uint64_t(IO_COUT_ADDR)
    && addr < (uint64_t(IO_COUT_ADDR) + IO_COUT_SIZE)) {
      this->writeToStdOut(data);
   } else {
+    this->track_dirty_pages(addr, size);
     mmu_.write(data, addr, size, 0);
   }
+  OBSERVE(observer_, DMEM_WRITE, on_dmem_write(addr, data, size));
   DT(2, "Mem Write: addr=0x" << std::hex << addr << ", data=0x" << ByteStream(data, size) << " (size=" << size << ", type=" << type << ")");
 }
 
 uint32_t Core::get_csr(uint32_t addr) {
-  // stall-independent mcycle workaround for software timing consistency
-  uint64_t ideal_mcycles = (perf_stats_.instrs-1) + 5;
+  // CSR instructions execute at the ROB head, so every older instruction has
+  // committed and the counters are exact; IDEAL_MCYCLE restores the old
+  // stall-independent estimate
+  uint64_t mcycles = IDEAL_MCYCLE ? ((perf_stats_.instrs-1) + 5) : perf_stats_.cycles;
   switch (addr) {
   case VX_CSR_MHARTID:
   case VX_CSR_SATP:
@@ -165,15 +260,29 @@ uint32_t Core::get_csr(uint32_t addr) {
   case VX_CSR_MEPC:
   case VX_CSR_MNSTATUS:
     return 0;
+  case VX_CSR_ROI:
+    return region_id_;
+  case VX_CSR_ROI_NAME:
+    return 0;
   case VX_CSR_MCYCLE: // NumCycles
-    return ideal_mcycles & 0xffffffff;
+    return mcycles & 0xffffffff;
   case VX_CSR_MCYCLE_H: // NumCycles
-    return (uint32_t)(ideal_mcycles >> 32);
+    return (uint32_t)(mcycles >> 32);
   case VX_CSR_MINSTRET: // NumInsts
     return perf_stats_.instrs & 0xffffffff;
   case VX_CSR_MINSTRET_H: // NumInsts
     return (uint32_t)(perf_stats_.instrs >> 32);
   default:
+    if (addr >= VX_CSR_MPM_USER && addr < (VX_CSR_MPM_USER + VX_HPM_COUNTERS))
+      return this->hpm_counter(addr - VX_CSR_MPM_USER) & 0xffffffff;
+    if (addr >= VX_CSR_MPM_USER_H && addr < (VX_CSR_MPM_USER_H + VX_HPM_COUNTERS))
+      return (uint32_t)(this->hpm_counter(addr - VX_CSR_MPM_USER_H) >> 32);
+    if (addr >= VX_CSR_HPM_USER && addr < (VX_CSR_HPM_USER + VX_HPM_COUNTERS))
+      return this->hpm_counter(addr - VX_CSR_HPM_USER) & 0xffffffff;
+    if (addr >= VX_CSR_HPM_USER_H && addr < (VX_CSR_HPM_USER_H + VX_HPM_COUNTERS))
+      return (uint32_t)(this->hpm_counter(addr - VX_CSR_HPM_USER_H) >> 32);
+    if (addr >= VX_CSR_MHPMEVENT3 && addr < (VX_CSR_MHPMEVENT3 + VX_HPM_COUNTERS))
+      return mhpmevent_[addr - VX_CSR_MHPMEVENT3];
     std::cout << std::hex << "Error: invalid CSR read addr=0x" << addr << std::endl;
     std::abort();
     return 0;
@@ -193,7 +302,27 @@ void Core::set_csr(uint32_t addr, uint32_t value) {
   case VX_CSR_PMPADDR0:
   case VX_CSR_MNSTATUS:
     break;
+  case VX_CSR_ROI:
+    this->set_region(value);
+    break;
+  case VX_CSR_ROI_NAME:
+    region_name_ = this->read_guest_string(value);
+    break;
   default: {
+      if (addr >= VX_CSR_MPM_USER && addr < (VX_CSR_MPM_USER + VX_HPM_COUNTERS)) {
+        auto index = addr - VX_CSR_MPM_USER;
+        this->set_hpm_counter(index, (this->hpm_counter(index) & 0xffffffff00000000ull) | value);
+        break;
+      }
+      if (addr >= VX_CSR_MPM_USER_H && addr < (VX_CSR_MPM_USER_H + VX_HPM_COUNTERS)) {
+        auto index = addr - VX_CSR_MPM_USER_H;
+        this->set_hpm_counter(index, (this->hpm_counter(index) & 0xffffffff) | (uint64_t(value) << 32));
+        break;
+      }
+      if (addr >= VX_CSR_MHPMEVENT3 && addr < (VX_CSR_MHPMEVENT3 + VX_HPM_COUNTERS)) {
+        this->set_hpm_event(addr - VX_CSR_MHPMEVENT3, value);
+        break;
+      }
       std::cout << std::hex << "Error: invalid CSR write addr=0x" << addr << ", value=0x" << value << std::endl;
       std::abort();
     }
@@ -217,6 +346,10 @@ void Core::cout_flush() {
 }
 
 bool Core::check_exit(Word* exitcode, bool riscv_test) const {
+  if (wedged_) {
+    *exitcode = WATCHDOG_EXIT_CODE;
+    return true;
+  }
   if (exited_) {
     Word ec = reg_file_.at(3);
     if (riscv_test) {
@@ -233,10 +366,158 @@ bool Core::running() const {
   return (perf_stats_.instrs != fetched_instrs_) || (fetched_instrs_ == 0);
 }
 
-void Core::attach_ram(RAM* ram) {
+void Core::attach_ram(MemDevice* ram) {
   mmu_.attach(*ram, 0, 0xFFFFFFFF);
 }
 
+void Core::track_dirty_pages(uint64_t addr, uint32_t size) {
+  // save the page content before its first write
+  uint64_t first_page = addr / RAM_PAGE_SIZE;
+  uint64_t last_page = (addr + size - 1) / RAM_PAGE_SIZE;
+  for (uint64_t page = first_page; page <= last_page; ++page) {
+    if (dirty_pages_.count(page) != 0)
+      continue;
+    auto& pristine = dirty_pages_[page];
+    pristine.resize(RAM_PAGE_SIZE);
+    mmu_.read(pristine.data(), page * RAM_PAGE_SIZE, RAM_PAGE_SIZE, 0);
+  }
+}
+
+uint32_t Core::restore_dirty_pages() {
+  uint32_t num_pages = dirty_pages_.size();
+  for (auto& it : dirty_pages_) {
+    mmu_.write(it.second.data(), it.first * RAM_PAGE_SIZE, RAM_PAGE_SIZE, 0);
+  }
+  dirty_pages_.clear();
+  return num_pages;
+}
+
+void Core::write_interval() {
+  auto& base = interval_base_;
+  uint64_t cycles = perf_stats_.cycles - base.cycles;
+  uint64_t instrs = perf_stats_.instrs - base.instrs;
+  interval_->begin();
+  interval_->field("cycle", perf_stats_.cycles);
+  interval_->field("cycles", cycles);
+  interval_->field("instrs", instrs);
+  interval_->field("ipc", cycles ? (double(instrs) / cycles) : 0.0);
+  for (int i = 0; i < (int)StallCause::Count; ++i) {
+    auto key = std::string("stall_") + stall_cause_names[i];
+    interval_->field(key.c_str(), perf_stats_.stalls[i] - base.stalls[i]);
+  }
+  auto occupancy = occupancy_.sums();
+  auto& occ_base = occupancy_base_;
+  double samples = cycles ? double(cycles) : 1.0;
+  interval_->field("rob_avg", (occupancy.rob - occ_base.rob) / samples);
+  interval_->field("rs_avg", (occupancy.rs - occ_base.rs) / samples);
+  interval_->field("idq_avg", (occupancy.idq - occ_base.idq) / samples);
+  interval_->field("isq_avg", (occupancy.isq - occ_base.isq) / samples);
+  interval_->field("fus_avg", (occupancy.fus - occ_base.fus) / samples);
+  for (int i = (int)Limiter::ROB; i < (int)Limiter::Count; ++i) {
+    auto key = std::string("full_") + OccupancyStats::limiter_name((Limiter)i);
+    interval_->field(key.c_str(), occupancy.limiter[i] - occ_base.limiter[i]);
+  }
+  occupancy_base_ = occupancy;
+  interval_->end();
+  interval_base_ = perf_stats_;
+}
+
+void Core::write_stat_page() {
+  stat_page_->begin(perf_stats_.cycles);
+  stat_page_->field("cycles", perf_stats_.cycles);
+  stat_page_->field("instrs", perf_stats_.instrs);
+  for (int i = 0; i < (int)StallCause::Count; ++i) {
+    auto key = std::string("stall_") + stall_cause_names[i];
+    stat_page_->field(key.c_str(), perf_stats_.stalls[i]);
+  }
+  auto occupancy = occupancy_.sums();
+  stat_page_->field("rob_sum", occupancy.rob);
+  stat_page_->field("rs_sum", occupancy.rs);
+  stat_page_->field("idq_sum", occupancy.idq);
+  stat_page_->field("isq_sum", occupancy.isq);
+  stat_page_->field("fus_sum", occupancy.fus);
+  for (int i = VX_HPM_EVENT_NONE + 1; i < VX_HPM_EVENT_COUNT; ++i) {
+    auto key = std::string("hpm_") + hpm_event_names[i];
+    stat_page_->field(key.c_str(), this->hpm_event(i));
+  }
+  stat_page_->field("exited", exited_);
+  stat_page_->field("wedged", wedged_);
+  stat_page_->end();
+}
+
+std::string Core::read_guest_string(uint32_t addr) {
+  std::string str;
+  for (uint32_t i = 0; i < 64; ++i) {
+    char c = 0;
+    mmu_.read(&c, addr + i, 1, 0);
+    if (c == 0)
+      break;
+    str += c;
+  }
+  return str;
+}
+
+void Core::set_region(uint32_t id) {
+  // close the active region
+  if (region_id_ != 0) {
+    regions_[region_].accumulate(perf_stats_, region_base_);
+    DT(2, "ROI end: " << region_);
+  }
+  region_id_ = id;
+  if (id != 0) {
+    region_ = region_name_.empty() ? ("roi" + std::to_string(id)) : region_name_;
+    region_name_.clear();
+    regions_[region_]; // make sure an unterminated region is still reported
+    region_base_ = perf_stats_;
+    DT(2, "ROI begin: " << region_);
+  }
+}
+
+uint64_t Core::hpm_event(uint32_t event) const {
+  return hpm_events_[event];
+}
+
+uint64_t Core::hpm_counter(uint32_t index) const {
+  return this->hpm_event(mhpmevent_[index]) - mhpmcounter_base_[index];
+}
+
+void Core::set_hpm_counter(uint32_t index, uint64_t value) {
+  // rebase so that the counter resumes counting from value
+  mhpmcounter_base_[index] = this->hpm_event(mhpmevent_[index]) - value;
+}
+
+void Core::set_hpm_event(uint32_t index, uint32_t event) {
+  auto value = this->hpm_counter(index);
+  // WARL: unsupported selectors read back as no event
+  mhpmevent_[index] = (event < VX_HPM_EVENT_COUNT) ? event : VX_HPM_EVENT_NONE;
+  this->set_hpm_counter(index, value);
+}
+
+void Core::print_perf(const std::string& tag, const PerfStats& stats) {
+  std::cout << std::dec << "PERF" << tag << ": instrs=" << stats.instrs << ", cycles=" << stats.cycles << std::endl;
+  if (stats.instrs != 0) {
+    // CPI stack: one cycle per committed instruction plus the idle commit cycles by cause
+    auto instrs = double(stats.instrs);
+    std::cout << std::fixed << std::setprecision(3) << "PERF" << tag << ": cpi_base=" << 1.0;
+    for (int i = 0; i < (int)StallCause::Count; ++i) {
+      std::cout << ", cpi_" << stall_cause_names[i] << "=" << (stats.stalls[i] / instrs);
+    }
+    std::cout << std::defaultfloat << std::endl;
+  }
+}
+
 void Core::showStats() {
-  std::cout << std::dec << "PERF: instrs=" << perf_stats_.instrs << ", cycles=" << perf_stats_.cycles << std::endl;
+  this->print_perf("", perf_stats_);
+  occupancy_.print(std::cout);
+  latency_.print(std::cout);
+  instr_mix_.print(std::cout);
+
+  for (auto& it : regions_) {
+    auto stats = it.second;
+    if (region_id_ != 0 && it.first == region_) {
+      // region still open at exit
+      stats.accumulate(perf_stats_, region_base_);
+    }
+    this->print_perf("[" + it.first + "]", stats);
+  }
 }
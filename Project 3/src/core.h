@@ -22,6 +22,8 @@
 #include <sstream>
 #include <memory>
 #include <set>
+#include <array>
+#include <map>
 #include <simobject.h>
 #include <mem.h>
 #include "debug.h"
@@ -29,12 +31,24 @@
 #include "val_reg.h"
 #include "fifo_reg.h"
 #include "instr.h"
+#include "observer.h"
+#include "bintrace.h"
+#include "konata.h"
+#include "pcprof.h"
+#include "callprof.h"
+#include "interval.h"
+#include "statpage.h"
+#include "memprof.h"
+#include "patprof.h"
 #include "RAT.h"
 #include "RS.h"
 #include "RST.h"
 #include "ROB.h"
 #include "FU.h"
 #include "CDB.h"
+#include "occupancy.h"
+#include "latency.h"
+#include "instrmix.h"
 
 namespace tinyrv {
 
@@ -42,16 +56,41 @@ class ProcessorImpl;
 class Instr;
 class RAM;
 
+// cause charged to a cycle in which the ROB head did not commit
+enum class StallCause {
+  Alu,      // head executing on the ALU
+  Bru,      // head executing on the BRU
+  Lsu,      // head executing on the LSU
+  Sfu,      // head executing on the SFU
+  Cdb,      // head result ready but lost the CDB arbitration
+  RsFull,   // head pending while issue is blocked on a full RS
+  RobFull,  // head pending while issue is blocked on a full ROB
+  Branch,   // ROB drained behind a fetch stall on an unresolved branch
+  Frontend, // ROB empty during pipeline fill or decode
+  Count
+};
+
 class Core : public SimObject<Core> {
 public:
   struct PerfStats {
     uint64_t cycles;
     uint64_t instrs;
+    uint64_t stalls[(int)StallCause::Count];
 
     PerfStats()
       : cycles(0)
       , instrs(0)
+      , stalls()
     {}
+
+    // adds the counters elapsed between two snapshots
+    void accumulate(const PerfStats& end, const PerfStats& begin) {
+      cycles += end.cycles - begin.cycles;
+      instrs += end.instrs - begin.instrs;
+      for (int i = 0; i < (int)StallCause::Count; ++i) {
+        stalls[i] += end.stalls[i] - begin.stalls[i];
+      }
+    }
   };
 
   Core(const SimContext& ctx, uint32_t core_id, ProcessorImpl* processor);
@@ -61,7 +100,9 @@ public:
 
   void tick();
 
-  void attach_ram(RAM* ram);
+  void attach_ram(MemDevice* ram);
+
+  uint32_t restore_dirty_pages();
 
   bool running() const;
 
@@ -69,8 +110,66 @@ public:
 
   void showStats();
 
+  const PerfStats& perf_stats() const {
+    return perf_stats_;
+  }
+
+  void set_observer(CoreObserver* observer) {
+    observer_ = observer;
+  }
+
+  void attach_tracer(TraceWriter* tracer) {
+    tracer_ = tracer;
+  }
+
+  void attach_konata(KonataWriter* konata) {
+    konata_ = konata;
+  }
+
+  void attach_pc_profile(PCProfiler* pc_profile) {
+    pc_profile_ = pc_profile;
+  }
+
+  void attach_call_profile(CallProfiler* call_profile) {
+    call_profile_ = call_profile;
+  }
+
+  void attach_interval(IntervalWriter* interval) {
+    interval_ = interval;
+  }
+
+  void attach_stat_page(StatPage* stat_page) {
+    stat_page_ = stat_page;
+  }
+
+  void attach_mem_profile(MemProfiler* mem_profile) {
+    mem_profile_ = mem_profile;
+  }
+
+  void attach_pattern_profile(PatternProfiler* pattern_profile) {
+    pattern_profile_ = pattern_profile;
+  }
+
 private:
 
+  void write_interval();
+
+  void write_stat_page();
+
+  void print_perf(const std::string& tag, const PerfStats& stats);
+
+  void set_region(uint32_t id);
+
+  std::string read_guest_string(uint32_t addr);
+
+  uint64_t hpm_event(uint32_t event) const;
+
+  uint64_t hpm_counter(uint32_t index) const;
+
+  void set_hpm_counter(uint32_t index, uint64_t value);
+
+  void set_hpm_event(uint32_t index, uint32_t event);
+
   Instr::Ptr decode(uint32_t instr_code, uint32_t PC, uint64_t uuid) const;
 
   void dmem_read(void* data, uint64_t addr, uint32_t size);
@@ -81,6 +180,8 @@ private:
 
   uint32_t get_csr(uint32_t addr);
 
+  void track_dirty_pages(uint64_t addr, uint32_t size);
+
   void writeToStdOut(const void* data);
 
   void cout_flush();
@@ -89,6 +190,7 @@ private:
     uint32_t instr_code;
     Word     PC;
     uint64_t uuid;
+    uint64_t cycle;
   };
 
   struct is_data_t {
@@ -108,6 +210,14 @@ private:
   void writeback();
   void commit();
 
+  StallCause commit_stall_cause() const;
+
+  void watchdog_report(std::ostream& os) const;
+
+  void sample_occupancy();
+
+  uint32_t oldest_PC();
+
   uint32_t core_id_;
   ProcessorImpl* processor_;
   MemoryUnit mmu_;
@@ -127,11 +237,54 @@ private:
   std::vector<FunctionalUnit::Ptr> FUs_;
   bool exited_;
 
+  // forward-progress watchdog
+  uint64_t last_commit_cycle_;
+  bool wedged_;
+
+  // an issued branch is holding fetch until the BRU resolves it
+  bool branch_issued_;
+
   std::stringstream cout_buf_;
 
+  // pristine copies of the guest pages written since the last restore
+  std::unordered_map<uint64_t, std::vector<Byte>> dirty_pages_;
+
   uint64_t uuid_ctr_;
 
+  CoreObserver* observer_;
+  TraceWriter* tracer_;
+  KonataWriter* konata_;
+  PCProfiler* pc_profile_;
+  CallProfiler* call_profile_;
+  IntervalWriter* interval_;
+  StatPage* stat_page_;
+  MemProfiler* mem_profile_;
+  PatternProfiler* pattern_profile_;
+
+  // region of each executed memory access until it commits, and the commit
+  // stall cycles of the LSU instruction at the ROB head
+  std::unordered_map<uint64_t, int> mem_regions_;
+  uint64_t mem_stall_cycles_;
+
   PerfStats perf_stats_;
+  PerfStats interval_base_;
+
+  // region-of-interest counters, keyed by region name
+  std::map<std::string, PerfStats> regions_;
+  std::string region_;
+  std::string region_name_;
+  uint32_t    region_id_;
+  PerfStats   region_base_;
+
+  // guest-visible hardware performance monitors: raw event counts, and for
+  // each mhpmcounter its selected event and the count it was rebased from
+  std::array<uint64_t, VX_HPM_EVENT_COUNT> hpm_events_;
+  std::array<uint32_t, VX_HPM_COUNTERS> mhpmevent_;
+  std::array<uint64_t, VX_HPM_COUNTERS> mhpmcounter_base_;
+  OccupancyStats::sums_t occupancy_base_;
+  OccupancyStats occupancy_;
+  LatencyStats latency_;
+  InstrMix instr_mix_;
   uint64_t fetched_instrs_;
 
   friend class ALU;
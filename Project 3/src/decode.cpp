@@ -163,7 +163,7 @@ static const char* op_string(const Instr &instr) {
   }
 }
 
-std::ostream &operator<<(std::ostream &os, const Instr &instr) {
+std::ostream &print_asm(std::ostream &os, const Instr &instr) {
   os << op_string(instr);
   int sep = 0;
 
@@ -189,6 +189,12 @@ std::ostream &operator<<(std::ostream &os, const Instr &instr) {
     os << "0x" << std::hex << instr.getImm();
   }
 
+  return os;
+}
+
+std::ostream &operator<<(std::ostream &os, const Instr &instr) {
+  print_asm(os, instr);
+
   os << ", PC=0x" << std::hex << instr.getPC() << std::dec;
 
   os << " (#" << instr.getId() << ")";
@@ -199,6 +205,10 @@ std::ostream &operator<<(std::ostream &os, const Instr &instr) {
 }
 
 Instr::Ptr Core::decode(uint32_t instr_code, uint32_t PC, uint64_t uuid) const {
+  return decode_instr(instr_code, PC, uuid);
+}
+
+Instr::Ptr tinyrv::decode_instr(uint32_t instr_code, uint32_t PC, uint64_t uuid) {
   auto instr = std::make_shared<Instr>(uuid, PC);
   auto opcode = Opcode((instr_code >> shift_opcode) & mask_opcode);
 
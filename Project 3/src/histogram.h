@@ -0,0 +1,87 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <ostream>
+
+namespace tinyrv {
+
+// Integer histogram with one bin per value, grown on demand.
+class Histogram {
+public:
+  Histogram() : samples_(0), total_(0) {}
+
+  void sample(uint32_t value) {
+    if (value >= bins_.size()) {
+      bins_.resize(value + 1, 0);
+    }
+    ++bins_[value];
+    ++samples_;
+    total_ += value;
+  }
+
+  void reset() {
+    bins_.clear();
+    samples_ = 0;
+    total_ = 0;
+  }
+
+  uint64_t samples() const {
+    return samples_;
+  }
+
+  uint64_t sum() const {
+    return total_;
+  }
+
+  double mean() const {
+    return samples_ ? (double(total_) / samples_) : 0.0;
+  }
+
+  uint32_t max() const {
+    return bins_.empty() ? 0 : (bins_.size() - 1);
+  }
+
+  // smallest value covering the given fraction of the samples
+  uint32_t percentile(double p) const {
+    uint64_t target = uint64_t(p * samples_ + 0.5);
+    uint64_t count = 0;
+    for (uint32_t i = 0; i < bins_.size(); ++i) {
+      count += bins_[i];
+      if (count >= target && count != 0)
+        return i;
+    }
+    return this->max();
+  }
+
+  // prints the non-empty bins as value:count
+  void print(std::ostream& os) const {
+    bool first = true;
+    for (uint32_t i = 0; i < bins_.size(); ++i) {
+      if (bins_[i] == 0)
+        continue;
+      os << (first ? "" : " ") << i << ":" << bins_[i];
+      first = false;
+    }
+  }
+
+private:
+  std::vector<uint64_t> bins_;
+  uint64_t samples_;
+  uint64_t total_;
+};
+
+}
@@ -0,0 +1,111 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include <mem.h>
+#include "types.h"
+
+namespace tinyrv {
+
+// Immutable paged copy of a program image.
+// The whole pages of a .bin image are a read-only mapping of the file, so
+// every process simulating the same binary shares them through the page
+// cache. Partial pages and .hex images are private copies.
+class ProgramImage {
+public:
+  typedef std::shared_ptr<const ProgramImage> Ptr;
+
+  ProgramImage(uint32_t page_size);
+
+  ~ProgramImage();
+
+  bool loadBinImage(const char* filename, uint64_t destination);
+
+  bool loadHexImage(const char* filename);
+
+  // returns nullptr if the page is not part of the image
+  const Byte* page(uint64_t page_index) const;
+
+  uint32_t page_size() const {
+    return page_size_;
+  }
+
+  uint32_t num_pages() const {
+    return pages_.size();
+  }
+
+private:
+
+  void write(const void* data, uint64_t addr, uint64_t size);
+
+  uint32_t page_size_;
+  std::unordered_map<uint64_t, const Byte*> pages_;
+  std::unordered_map<uint64_t, std::vector<Byte>> private_pages_;
+  void*    mapping_;
+  uint64_t mapping_size_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Process-wide cache loading each program image once; separate processes
+// share the file-backed pages of the images they load.
+class ImageCache {
+public:
+  static ImageCache& instance();
+
+  // returns nullptr if the image cannot be loaded
+  ProgramImage::Ptr get(const char* filename, uint32_t page_size);
+
+private:
+  ImageCache() {}
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, ProgramImage::Ptr> images_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Copy-on-write memory view over a shared program image.
+// Pages are duplicated on their first write, untouched pages stay shared.
+class ImageRAM : public MemDevice {
+public:
+  ImageRAM(ProgramImage::Ptr image);
+
+  ~ImageRAM();
+
+  uint64_t size() const override;
+
+  void read(void* data, uint64_t addr, uint64_t size) override;
+
+  void write(const void* data, uint64_t addr, uint64_t size) override;
+
+  uint32_t num_private_pages() const {
+    return private_pages_.size();
+  }
+
+private:
+
+  Byte* writable_page(uint64_t page_index);
+
+  ProgramImage::Ptr image_;
+  uint32_t page_size_;
+  std::unordered_map<uint64_t, std::vector<Byte>> private_pages_;
+};
+
+}
@@ -45,6 +45,14 @@ class Instr {
 public:
   typedef std::shared_ptr<Instr> Ptr;
 
+  // cycle stamps recorded as the instruction moves through the pipeline
+  struct timing_t {
+    uint64_t fetch;
+    uint64_t issue;
+    uint64_t dispatch;
+    uint64_t complete;
+  };
+
   Instr(uint64_t uuid, uint32_t PC)
     : uuid_(uuid)
     , PC_(PC)
@@ -57,6 +65,8 @@ public:
     , func7_(0)
     , alu_op_(AluOp::ADD)
     , exe_flags_(ExeFlags{})
+    , br_taken_(false)
+    , timing_({0, 0, 0, 0})
   {}
 
   void setOpcode(Opcode opcode)  {
@@ -103,6 +113,11 @@ public:
     fu_type_ = value;
   }
 
+  // branch direction resolved by the BRU
+  void setBrTaken(bool value) {
+    br_taken_ = value;
+  }
+
   uint64_t getId() const { return uuid_; }
   uint32_t getPC() const { return PC_; }
 
@@ -118,6 +133,10 @@ public:
   BrOp     getBrOp() const { return br_op_; };
   ExeFlags getExeFlags() const { return exe_flags_; }
   FUType   getFUType() const { return fu_type_; }
+  bool     isBrTaken() const { return br_taken_; }
+
+  timing_t& timing() { return timing_; }
+  const timing_t& timing() const { return timing_; }
 
 private:
 
@@ -136,8 +155,17 @@ private:
   BrOp      br_op_;
   ExeFlags  exe_flags_;
   FUType    fu_type_;
+  bool      br_taken_;
+
+  timing_t  timing_;
 
   friend std::ostream &operator<<(std::ostream &, const Instr&);
 };
 
-}
\ No newline at end of file
+// mnemonic and operands only
+std::ostream &print_asm(std::ostream &os, const Instr &instr);
+
+// decodes a raw instruction word, returns nullptr for an invalid opcode
+Instr::Ptr decode_instr(uint32_t instr_code, uint32_t PC = 0, uint64_t uuid = 0);
+
+}
@@ -0,0 +1,127 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <string.h>
+#include "instrmix.h"
+
+using namespace tinyrv;
+
+static constexpr uint64_t NO_WRITER = ~uint64_t(0);
+
+static const char* opcode_name(int opcode) {
+  switch ((Opcode)opcode) {
+  case Opcode::R:     return "R";
+  case Opcode::L:     return "L";
+  case Opcode::I:     return "I";
+  case Opcode::S:     return "S";
+  case Opcode::B:     return "B";
+  case Opcode::LUI:   return "LUI";
+  case Opcode::AUIPC: return "AUIPC";
+  case Opcode::JAL:   return "JAL";
+  case Opcode::JALR:  return "JALR";
+  case Opcode::SYS:   return "SYS";
+  case Opcode::FENCE: return "FENCE";
+  default:            return "NONE";
+  }
+}
+
+InstrMix::InstrMix() {
+  this->reset();
+}
+
+void InstrMix::reset() {
+  memset(opcodes_, 0, sizeof(opcodes_));
+  memset(alu_ops_, 0, sizeof(alu_ops_));
+  memset(br_ops_, 0, sizeof(br_ops_));
+  memset(br_taken_, 0, sizeof(br_taken_));
+  memset(fu_types_, 0, sizeof(fu_types_));
+  dep_distance_.reset();
+  std::fill(std::begin(last_writer_), std::end(last_writer_), NO_WRITER);
+  seq_ = 0;
+}
+
+void InstrMix::commit(const Instr& instr) {
+  ++opcodes_[(int)instr.getOpcode() % NUM_OPCODES];
+  ++alu_ops_[(int)instr.getAluOp()];
+  ++br_ops_[(int)instr.getBrOp()];
+  ++fu_types_[(int)instr.getFUType()];
+
+  auto br_op = instr.getBrOp();
+  if (br_op != BrOp::NONE && br_op != BrOp::JAL && br_op != BrOp::JALR
+   && instr.isBrTaken()) {
+    ++br_taken_[(int)br_op];
+  }
+
+  // distance to the producer of each source register
+  auto exe_flags = instr.getExeFlags();
+  uint32_t srcs[] = {exe_flags.use_rs1 ? instr.getRs1() : 0,
+                     exe_flags.use_rs2 ? instr.getRs2() : 0};
+  for (auto reg : srcs) {
+    if (reg == 0 || last_writer_[reg] == NO_WRITER)
+      continue;
+    auto distance = std::min<uint64_t>(seq_ - last_writer_[reg], MAX_DEP_DISTANCE);
+    dep_distance_.sample(distance);
+  }
+  if (exe_flags.use_rd && instr.getRd() != 0) {
+    last_writer_[instr.getRd()] = seq_;
+  }
+  ++seq_;
+}
+
+void InstrMix::print(std::ostream& os) const {
+  os << "MIX: opcode:";
+  for (int i = 0, sep = 0; i < NUM_OPCODES; ++i) {
+    if (opcodes_[i] != 0) {
+      os << (sep++ ? ", " : " ") << opcode_name(i) << "=" << opcodes_[i];
+    }
+  }
+  os << std::endl;
+
+  os << "MIX: alu_op:";
+  for (int i = 0, sep = 0; i < NUM_ALU_OPS; ++i) {
+    if (alu_ops_[i] != 0) {
+      os << (sep++ ? ", " : " ") << (AluOp)i << "=" << alu_ops_[i];
+    }
+  }
+  os << std::endl;
+
+  os << "MIX: br_op:";
+  for (int i = (int)BrOp::JAL, sep = 0; i < NUM_BR_OPS; ++i) {
+    if (br_ops_[i] == 0)
+      continue;
+    os << (sep++ ? ", " : " ") << (BrOp)i << "=" << br_ops_[i];
+    if (i != (int)BrOp::JAL && i != (int)BrOp::JALR) {
+      os << " (taken " << std::fixed << std::setprecision(1)
+         << (100.0 * br_taken_[i] / br_ops_[i]) << "%)" << std::defaultfloat;
+    }
+  }
+  os << std::endl;
+
+  os << "MIX: fu_type:";
+  for (int i = 0, sep = 0; i < NUM_FU_TYPES; ++i) {
+    if (fu_types_[i] != 0) {
+      os << (sep++ ? ", " : " ") << (FUType)i << "=" << fu_types_[i];
+    }
+  }
+  os << std::endl;
+
+  os << "MIX: dep_distance: mean=" << std::fixed << std::setprecision(2) << dep_distance_.mean() << std::defaultfloat
+     << ", p50=" << dep_distance_.percentile(0.50)
+     << ", p90=" << dep_distance_.percentile(0.90)
+     << ", histogram: ";
+  dep_distance_.print(os);
+  os << std::endl;
+}
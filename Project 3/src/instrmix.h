@@ -0,0 +1,58 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <ostream>
+#include "config.h"
+#include "instr.h"
+#include "histogram.h"
+
+namespace tinyrv {
+
+// Dynamic instruction mix of the committed stream: counts per opcode,
+// ALU operation, branch operation and FU type, register dependency
+// distances (in committed instructions) and conditional branch taken rates.
+class InstrMix {
+public:
+  // distances at or above this value share the last bin
+  static constexpr uint32_t MAX_DEP_DISTANCE = 64;
+
+  InstrMix();
+
+  void reset();
+
+  void commit(const Instr& instr);
+
+  void print(std::ostream& os) const;
+
+private:
+
+  static constexpr int NUM_OPCODES   = 128;
+  static constexpr int NUM_ALU_OPS   = (int)AluOp::LTU + 1;
+  static constexpr int NUM_BR_OPS    = (int)BrOp::BGEU + 1;
+  static constexpr int NUM_FU_TYPES  = (int)FUType::NONE + 1;
+
+  uint64_t opcodes_[NUM_OPCODES];
+  uint64_t alu_ops_[NUM_ALU_OPS];
+  uint64_t br_ops_[NUM_BR_OPS];
+  uint64_t br_taken_[NUM_BR_OPS];
+  uint64_t fu_types_[NUM_FU_TYPES];
+
+  Histogram dep_distance_;
+  uint64_t  last_writer_[NUM_REGS];
+  uint64_t  seq_;
+};
+
+}
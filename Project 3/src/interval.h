@@ -0,0 +1,50 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <fstream>
+
+namespace tinyrv {
+
+// Periodic statistics snapshots written as JSON Lines, one object per
+// interval, flushed as they are produced. The interval is counted either
+// in cycles or in committed instructions.
+class IntervalWriter {
+public:
+  IntervalWriter(const char* filename, uint64_t period, bool by_instrs);
+
+  ~IntervalWriter();
+
+  // is the interval starting at the given counters complete?
+  bool due(uint64_t cycles, uint64_t instrs) const {
+    return by_instrs_ ? (instrs >= period_) : (cycles >= period_);
+  }
+
+  void begin();
+
+  void field(const char* key, uint64_t value);
+
+  void field(const char* key, double value);
+
+  void end();
+
+private:
+  std::ofstream ofs_;
+  uint64_t period_;
+  bool     by_instrs_;
+  int      fields_;
+};
+
+}
@@ -0,0 +1,98 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include "latency.h"
+
+using namespace tinyrv;
+
+static const char* phase_names[] = {"fetch_issue", "issue_dispatch", "dispatch_complete", "complete_commit"};
+
+static const char* class_names[] = {"alu", "load", "store", "branch", "jump", "system"};
+
+static void print_histogram(std::ostream& os, const char* phase, const char* group, const Histogram& hist) {
+  if (hist.samples() == 0)
+    return;
+  os << "LAT: " << phase << " " << group
+     << ": n=" << hist.samples()
+     << ", mean=" << std::fixed << std::setprecision(2) << hist.mean() << std::defaultfloat
+     << ", p50=" << hist.percentile(0.50)
+     << ", p90=" << hist.percentile(0.90)
+     << ", p99=" << hist.percentile(0.99)
+     << ", max=" << hist.max()
+     << std::endl;
+}
+
+void LatencyStats::reset() {
+  for (int p = 0; p < (int)LatencyPhase::Count; ++p) {
+    total_[p].reset();
+    for (auto& hist : by_fu_) {
+      hist[p].reset();
+    }
+    for (auto& hist : by_class_) {
+      hist[p].reset();
+    }
+  }
+}
+
+OpClass LatencyStats::op_class(const Instr& instr) {
+  switch (instr.getOpcode()) {
+  case Opcode::L:     return OpClass::Load;
+  case Opcode::S:     return OpClass::Store;
+  case Opcode::B:     return OpClass::Branch;
+  case Opcode::JAL:
+  case Opcode::JALR:  return OpClass::Jump;
+  case Opcode::SYS:
+  case Opcode::FENCE: return OpClass::System;
+  default:            return OpClass::ALU;
+  }
+}
+
+void LatencyStats::record(const Instr& instr, uint64_t commit_cycle) {
+  auto& t = instr.timing();
+  uint32_t latencies[] = {
+    uint32_t(t.issue - t.fetch),
+    uint32_t(t.dispatch - t.issue),
+    uint32_t(t.complete - t.dispatch),
+    uint32_t(commit_cycle - t.complete)
+  };
+  auto& by_fu = by_fu_[(int)instr.getFUType()];
+  auto& by_class = by_class_[(int)op_class(instr)];
+  for (int p = 0; p < (int)LatencyPhase::Count; ++p) {
+    total_[p].sample(latencies[p]);
+    by_fu[p].sample(latencies[p]);
+    by_class[p].sample(latencies[p]);
+  }
+}
+
+void LatencyStats::print(std::ostream& os) const {
+  os << "PERF: " << std::fixed << std::setprecision(2);
+  for (int p = 0; p < (int)LatencyPhase::Count; ++p) {
+    os << (p ? ", " : "") << "lat_" << phase_names[p] << "=" << total_[p].mean();
+  }
+  os << std::defaultfloat << std::endl;
+
+  for (int p = 0; p < (int)LatencyPhase::Count; ++p) {
+    print_histogram(os, phase_names[p], "all", total_[p]);
+    for (int f = 0; f < NUM_FU_TYPES; ++f) {
+      std::stringstream ss;
+      ss << (FUType)f;
+      print_histogram(os, phase_names[p], ss.str().c_str(), by_fu_[f][p]);
+    }
+    for (int c = 0; c < (int)OpClass::Count; ++c) {
+      print_histogram(os, phase_names[p], class_names[c], by_class_[c][p]);
+    }
+  }
+}
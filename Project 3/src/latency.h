@@ -0,0 +1,65 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <ostream>
+#include "instr.h"
+#include "histogram.h"
+
+namespace tinyrv {
+
+enum class LatencyPhase {
+  FetchToIssue,       // front-end and issue stalls
+  IssueToDispatch,    // waiting in the reservation station
+  DispatchToComplete, // FU latency plus CDB arbitration
+  CompleteToCommit,   // waiting in the reorder buffer
+  Count
+};
+
+enum class OpClass {
+  ALU,
+  Load,
+  Store,
+  Branch,
+  Jump,
+  System,
+  Count
+};
+
+// Latency distribution of committed instructions, per pipeline phase,
+// broken down by functional unit and by opcode class.
+class LatencyStats {
+public:
+  LatencyStats() {}
+
+  void reset();
+
+  // records an instruction committed at the given cycle
+  void record(const Instr& instr, uint64_t commit_cycle);
+
+  void print(std::ostream& os) const;
+
+private:
+
+  static constexpr int NUM_FU_TYPES = (int)FUType::NONE + 1;
+
+  static OpClass op_class(const Instr& instr);
+
+  Histogram total_[(int)LatencyPhase::Count];
+  Histogram by_fu_[NUM_FU_TYPES][(int)LatencyPhase::Count];
+  Histogram by_class_[(int)OpClass::Count][(int)LatencyPhase::Count];
+};
+
+}
@@ -23,20 +23,85 @@
 #include "processor.h"
 #include "mem.h"
 #include "core.h"
+#include "image.h"
 
 using namespace tinyrv;
 
 static void show_usage() {
-   std::cout << "Usage: [-g: gshare] [-s: stats] [-h: help] <program>" << std::endl;
+   std::cout << "Usage: [-g: gshare] [-r <n>: repeat runs] [-t <file>: binary trace] [-k <file>: pipeline view] [-w <begin>:<end>: view cycles] [-a <file>: per-PC profile] [-f <file>: flame graph] [-m <file>: symbol map] [-o: data region profile] [-c <file>: access patterns] [-j <file>: interval stats] [-i <n>[i]: interval cycles or instrs] [-p: host profile] [-e <file>: live stats page] [-u <n>: live stats cycles] [-s: stats] [-h: help] <program>" << std::endl;
 }
 
 bool showStats = false;
 const char* program = nullptr;
+uint32_t numRuns = 1;
+const char* traceFile = nullptr;
+const char* konataFile = nullptr;
+uint64_t konataBegin = 0;
+uint64_t konataEnd = UINT64_MAX;
+const char* profileFile = nullptr;
+const char* flameFile = nullptr;
+const char* symbolFile = nullptr;
+const char* intervalFile = nullptr;
+uint64_t intervalPeriod = 100000;
+bool intervalByInstrs = false;
+bool hostProfile = false;
+const char* statPageFile = nullptr;
+uint64_t statPagePeriod = 10000;
+bool memProfile = false;
+const char* patternFile = nullptr;
 
 static void parse_args(int argc, char **argv) {
   int c;
-  while ((c = getopt(argc, argv, "gsh?")) != -1) {
+  while ((c = getopt(argc, argv, "gr:t:k:w:a:f:m:j:i:pe:u:oc:sh?")) != -1) {
     switch (c) {
+    case 'r':
+      numRuns = atoi(optarg);
+      break;
+    case 't':
+      traceFile = optarg;
+      break;
+    case 'k':
+      konataFile = optarg;
+      break;
+    case 'w': {
+      char* sep = nullptr;
+      konataBegin = strtoull(optarg, &sep, 0);
+      if (sep && *sep == ':') {
+        konataEnd = strtoull(sep + 1, nullptr, 0);
+      }
+    } break;
+    case 'a':
+      profileFile = optarg;
+      break;
+    case 'f':
+      flameFile = optarg;
+      break;
+    case 'm':
+      symbolFile = optarg;
+      break;
+    case 'j':
+      intervalFile = optarg;
+      break;
+    case 'i': {
+      char* suffix = nullptr;
+      intervalPeriod = strtoull(optarg, &suffix, 0);
+      intervalByInstrs = (suffix && *suffix == 'i');
+    } break;
+    case 'p':
+      hostProfile = true;
+      break;
+    case 'e':
+      statPageFile = optarg;
+      break;
+    case 'u':
+      statPagePeriod = strtoull(optarg, nullptr, 0);
+      break;
+    case 'o':
+      memProfile = true;
+      break;
+    case 'c':
+      patternFile = optarg;
+      break;
     case 's':
       showStats = true;
       break;
@@ -66,21 +131,12 @@ int main(int argc, char **argv) {
   parse_args(argc, argv);
 
   {
-    // create memory module
-    RAM ram(RAM_PAGE_SIZE);
-
-    // load program
-    {
-      std::string program_ext(fileExtension(program));
-      if (program_ext == "bin") {
-        ram.loadBinImage(program, STARTUP_ADDR);
-      } else if (program_ext == "hex") {
-        ram.loadHexImage(program);
-      } else {
-        std::cout << "*** error: only *.bin or *.hex images supported." << std::endl;
-        return -1;
-      }
-    }
+    // copy-on-write view over the program image, whose pristine pages are
+    // shared with every other simulation of the same binary
+    auto image = ImageCache::instance().get(program, RAM_PAGE_SIZE);
+    if (!image)
+      return -1;
+    ImageRAM ram(image);
 
     // create processor
     Processor processor;
@@ -88,17 +144,69 @@ int main(int argc, char **argv) {
     // attach memory module
     processor.attach_ram(&ram);
 
-    // run simulation
-    exitcode = processor.run(true);
-    if (exitcode != 0) {
-      std::cout << "*** FAILED: exitcode=" << exitcode << std::endl;
-    } else {
-      std::cout << "PASSED!" << std::endl;
+    // enable binary tracing
+    if (traceFile) {
+      processor.enable_trace(traceFile);
+    }
+
+    // enable pipeline viewer trace
+    if (konataFile) {
+      processor.enable_konata(konataFile, konataBegin, konataEnd);
+    }
+
+    // enable per-PC cycle attribution
+    if (profileFile) {
+      processor.enable_pc_profile(profileFile);
+    }
+
+    // enable guest function profiling
+    if (flameFile) {
+      processor.enable_call_profile(flameFile, symbolFile);
+    }
+
+    // enable interval statistics
+    if (intervalFile) {
+      processor.enable_interval_stats(intervalFile, intervalPeriod, intervalByInstrs);
     }
 
-    // show performance stats
-    if (showStats) {
-      processor.showStats();
+    // enable simulator self-profiling
+    if (hostProfile) {
+      processor.enable_host_profile();
+    }
+
+    // enable data region attribution
+    if (memProfile) {
+      processor.enable_mem_profile(symbolFile);
+    }
+
+    // enable load/store address pattern classification
+    if (patternFile) {
+      processor.enable_pattern_profile(patternFile);
+    }
+
+    // enable live statistics page
+    if (statPageFile) {
+      processor.enable_stat_page(statPageFile, statPagePeriod);
+    }
+
+    for (uint32_t run = 0; run < numRuns; ++run) {
+      // restore the pages written by the previous run
+      if (run != 0) {
+        processor.reset_to_image();
+      }
+
+      // run simulation
+      exitcode = processor.run(true);
+      if (exitcode != 0) {
+        std::cout << "*** FAILED: exitcode=" << exitcode << std::endl;
+      } else {
+        std::cout << "PASSED!" << std::endl;
+      }
+
+      // show performance stats
+      if (showStats) {
+        processor.showStats();
+      }
     }
   }
 
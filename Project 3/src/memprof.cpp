@@ -0,0 +1,156 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include "memprof.h"
+#include "config.h"
+
+using namespace tinyrv;
+
+MemProfiler::MemProfiler(const char* symfile)
+  : heap_start_(0) {
+  stack_ = this->add_region("stack");
+  heap_  = this->add_region("heap");
+  io_    = this->add_region("io");
+  other_ = this->add_region("other");
+  if (symfile) {
+    this->load_symbols(symfile);
+  }
+}
+
+int MemProfiler::add_region(const std::string& name) {
+  auto it = names_.find(name);
+  if (it != names_.end())
+    return it->second;
+  int index = regions_.size();
+  regions_.push_back({name, 0, 0, 0, 0});
+  names_[name] = index;
+  return index;
+}
+
+void MemProfiler::load_symbols(const char* symfile) {
+  // accepts "nm" or "nm -S" output: "<hex address> [<hex size>] <type> <name>"
+  std::ifstream ifs(symfile);
+  if (!ifs) {
+    std::cout << "Error: cannot open symbol map " << symfile << std::endl;
+    std::abort();
+  }
+  struct symbol_t {
+    uint32_t addr;
+    uint32_t size;
+    bool     data;
+    std::string name;
+  };
+  std::vector<symbol_t> symbols;
+  std::string line;
+  while (std::getline(ifs, line)) {
+    std::stringstream ss(line);
+    std::vector<std::string> tokens;
+    std::string token;
+    while (ss >> token) {
+      tokens.push_back(token);
+    }
+    if (tokens.size() < 3)
+      continue;
+    char* end = nullptr;
+    uint32_t addr = strtoul(tokens[0].c_str(), &end, 16);
+    if (*end != 0)
+      continue;
+    uint32_t size = (tokens.size() > 3) ? strtoul(tokens[1].c_str(), nullptr, 16) : 0;
+    auto& type = tokens[tokens.size() - 2];
+    auto& name = tokens.back();
+    bool data = (type.size() == 1 && strchr("bBdDgGrRsSvV", type[0]) != nullptr);
+    if (name == "_end" || name == "end") {
+      // end of bss, still bounds the symbol before it
+      heap_start_ = addr;
+      data = false;
+    }
+    symbols.push_back({addr, size, data, name});
+  }
+
+  // unsized symbols extend to the next symbol
+  std::sort(symbols.begin(), symbols.end(), [](const symbol_t& a, const symbol_t& b) {
+    return a.addr < b.addr;
+  });
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    auto& sym = symbols[i];
+    if (!sym.data)
+      continue;
+    uint32_t end = sym.addr + sym.size;
+    if (sym.size == 0) {
+      if (i + 1 == symbols.size())
+        continue;
+      end = symbols[i + 1].addr;
+    }
+    if (end > sym.addr) {
+      ranges_[sym.addr] = {end, this->add_region(sym.name)};
+    }
+  }
+}
+
+int MemProfiler::access(uint32_t addr, uint32_t size, bool is_write, uint32_t sp) {
+  int region = other_;
+  if (addr >= uint32_t(IO_BASE_ADDR)) {
+    region = io_;
+  } else {
+    auto it = ranges_.upper_bound(addr);
+    if (it != ranges_.begin() && addr < (--it)->second.end) {
+      region = it->second.region;
+    } else if (addr >= sp && addr < uint32_t(STACK_BASE_ADDR)) {
+      region = stack_;
+    } else if (heap_start_ != 0 && addr >= heap_start_ && addr < sp) {
+      region = heap_;
+    }
+  }
+  auto& stats = regions_[region];
+  if (is_write) {
+    ++stats.writes;
+  } else {
+    ++stats.reads;
+  }
+  stats.bytes += size;
+  return region;
+}
+
+void MemProfiler::stall(int region, uint64_t cycles) {
+  regions_.at(region).stall_cycles += cycles;
+}
+
+void MemProfiler::print(std::ostream& os) const {
+  std::vector<const region_t*> order;
+  bool stalls = false;
+  for (auto& region : regions_) {
+    if (region.reads + region.writes != 0) {
+      order.push_back(&region);
+    }
+    stalls |= (region.stall_cycles != 0);
+  }
+  // busiest regions first
+  std::stable_sort(order.begin(), order.end(), [](const region_t* a, const region_t* b) {
+    return (a->reads + a->writes) > (b->reads + b->writes);
+  });
+  for (auto region : order) {
+    os << std::dec << "MEM[" << region->name << "]: reads=" << region->reads
+       << ", writes=" << region->writes << ", bytes=" << region->bytes;
+    if (stalls) {
+      os << ", stall_cycles=" << region->stall_cycles;
+    }
+    os << std::endl;
+  }
+}
@@ -0,0 +1,76 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include "config.h"
+
+namespace tinyrv {
+
+class Instr;
+
+// Core event callbacks for embedding tools.
+// Each hook has its own EVENT_HOOK_* bit in EVENT_HOOKS. The OBSERVE() call
+// sites of a hook left out of the mask fold away at compile time and their
+// arguments are never evaluated, so a tool only pays for the hooks it uses.
+class CoreObserver {
+public:
+  virtual ~CoreObserver() {}
+
+  virtual void on_fetch(uint64_t uuid, uint32_t PC, uint32_t instr_code) {
+    (void) uuid; (void) PC; (void) instr_code;
+  }
+
+  virtual void on_decode(uint64_t uuid, uint32_t PC, const Instr& instr) {
+    (void) uuid; (void) PC; (void) instr;
+  }
+
+  virtual void on_issue(uint64_t uuid, uint32_t PC, const Instr& instr) {
+    (void) uuid; (void) PC; (void) instr;
+  }
+
+  virtual void on_commit(uint64_t uuid, uint32_t PC, const Instr& instr) {
+    (void) uuid; (void) PC; (void) instr;
+  }
+
+  virtual void on_branch(uint64_t uuid, uint32_t PC, bool taken, uint32_t target, bool mispredicted) {
+    (void) uuid; (void) PC; (void) taken; (void) target; (void) mispredicted;
+  }
+
+  virtual void on_dmem_read(uint64_t addr, const void* data, uint32_t size) {
+    (void) addr; (void) data; (void) size;
+  }
+
+  virtual void on_dmem_write(uint64_t addr, const void* data, uint32_t size) {
+    (void) addr; (void) data; (void) size;
+  }
+};
+
+}
+
+#define EVENT_HOOK_FETCH        (1 << 0)
+#define EVENT_HOOK_DECODE       (1 << 1)
+#define EVENT_HOOK_ISSUE        (1 << 2)
+#define EVENT_HOOK_COMMIT       (1 << 3)
+#define EVENT_HOOK_BRANCH       (1 << 4)
+#define EVENT_HOOK_DMEM_READ    (1 << 5)
+#define EVENT_HOOK_DMEM_WRITE   (1 << 6)
+#define EVENT_HOOK_ALL          0x7f
+
+#define OBSERVE(observer, hook, call) \
+  do { \
+    if ((EVENT_HOOKS & EVENT_HOOK_##hook) && (observer)) { \
+      (observer)->call; \
+    } \
+  } while (0)
@@ -0,0 +1,89 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <iomanip>
+#include "occupancy.h"
+
+using namespace tinyrv;
+
+static const char* limiter_names[] = {"none", "rob", "rs", "isq", "idq"};
+
+OccupancyStats::OccupancyStats() {}
+
+const char* OccupancyStats::limiter_name(Limiter limiter) {
+  return limiter_names[(int)limiter];
+}
+
+OccupancyStats::sums_t OccupancyStats::sums() const {
+  sums_t sums;
+  sums.rob = total_.rob.sum();
+  sums.rs  = total_.rs.sum();
+  sums.idq = total_.idq.sum();
+  sums.isq = total_.isq.sum();
+  sums.fus = total_.fus.sum();
+  for (int i = 0; i < (int)Limiter::Count; ++i) {
+    sums.limiter[i] = total_.limiter[i];
+  }
+  return sums;
+}
+
+void OccupancyStats::reset() {
+  total_ = stats_t();
+  interval_ = stats_t();
+}
+
+void OccupancyStats::sample(const sample_t& sample) {
+  for (auto stats : {&total_, &interval_}) {
+    stats->rob.sample(sample.rob);
+    stats->rs.sample(sample.rs);
+    stats->idq.sample(sample.idq);
+    stats->isq.sample(sample.isq);
+    stats->fus.sample(sample.fus);
+    ++stats->limiter[(int)sample.limiter];
+  }
+}
+
+void OccupancyStats::print_averages(std::ostream& os, const stats_t& stats) {
+  os << std::fixed << std::setprecision(2)
+     << "rob_avg=" << stats.rob.mean()
+     << ", rs_avg=" << stats.rs.mean()
+     << ", idq_avg=" << stats.idq.mean()
+     << ", isq_avg=" << stats.isq.mean()
+     << ", fus_avg=" << stats.fus.mean()
+     << std::defaultfloat;
+  for (int i = (int)Limiter::ROB; i < (int)Limiter::Count; ++i) {
+    os << ", full_" << limiter_names[i] << "=" << stats.limiter[i];
+  }
+}
+
+void OccupancyStats::dump_interval(std::ostream& os, uint64_t cycle) {
+  os << "OCC[" << cycle << "]: ";
+  print_averages(os, interval_);
+  os << std::endl;
+  interval_ = stats_t();
+}
+
+void OccupancyStats::print(std::ostream& os) const {
+  os << "PERF: ";
+  print_averages(os, total_);
+  os << std::endl;
+  struct { const char* name; const Histogram* hist; } hists[] = {
+    {"rob", &total_.rob}, {"rs", &total_.rs}, {"idq", &total_.idq}, {"isq", &total_.isq}, {"fus", &total_.fus}
+  };
+  for (auto& h : hists) {
+    os << "OCC: " << h.name << " histogram: ";
+    h.hist->print(os);
+    os << std::endl;
+  }
+}
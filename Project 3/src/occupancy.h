@@ -0,0 +1,89 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <ostream>
+#include "histogram.h"
+
+namespace tinyrv {
+
+// structure holding back the front-end in a given cycle
+enum class Limiter {
+  None,
+  ROB,  // issue blocked on a full reorder buffer
+  RS,   // issue blocked on full reservation stations
+  ISQ,  // decode blocked on a full issue queue
+  IDQ,  // fetch blocked on a full decode queue
+  Count
+};
+
+// Per-cycle occupancy of the out-of-order structures.
+// Statistics are kept for the whole run and for the current interval.
+class OccupancyStats {
+public:
+  struct sample_t {
+    uint32_t rob;
+    uint32_t rs;
+    uint32_t idq;
+    uint32_t isq;
+    uint32_t fus;
+    Limiter  limiter;
+  };
+
+  struct sums_t {
+    uint64_t rob;
+    uint64_t rs;
+    uint64_t idq;
+    uint64_t isq;
+    uint64_t fus;
+    uint64_t limiter[(int)Limiter::Count];
+  };
+
+  OccupancyStats();
+
+  void reset();
+
+  void sample(const sample_t& sample);
+
+  // prints and restarts the current interval
+  void dump_interval(std::ostream& os, uint64_t cycle);
+
+  void print(std::ostream& os) const;
+
+  // running totals since reset, for callers computing their own deltas
+  sums_t sums() const;
+
+  static const char* limiter_name(Limiter limiter);
+
+private:
+
+  struct stats_t {
+    Histogram rob;
+    Histogram rs;
+    Histogram idq;
+    Histogram isq;
+    Histogram fus;
+    uint64_t  limiter[(int)Limiter::Count];
+
+    stats_t() : limiter() {}
+  };
+
+  static void print_averages(std::ostream& os, const stats_t& stats);
+
+  stats_t total_;
+  stats_t interval_;
+};
+
+}
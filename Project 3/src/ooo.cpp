@@ -39,6 +39,13 @@ void Core::issue() {
   // check for structial hazards
   // TODO:
   if(RS_.full() || ROB_.full()){
+    if (ROB_.full()) {
+      ++hpm_events_[VX_HPM_EVENT_ROB_FULL];
+    }
+    if (RS_.full()) {
+      ++hpm_events_[VX_HPM_EVENT_RS_FULL];
+    }
+    BT(tracer_, perf_stats_.cycles, Issue, Stall, instr->getId(), instr->getPC(), (RS_.full() | (ROB_.full() << 1)), 0);
     return; // Stall for the next cycle
   }
 
@@ -102,6 +109,20 @@ void Core::issue() {
     }
   }
 
+  // capture the sp this LSU access follows in program order,
+  // later renames of x2 must not leak into its stack classification
+  int sp_rsid = -1;
+  uint32_t sp_data = reg_file_.at(2);
+  if (instr->getFUType() == FUType::LSU && RAT_.exists(2)) {
+    int rob_index = RAT_.get(2);
+    const auto& rob_entry = ROB_.get_entry(rob_index);
+    if (rob_entry.ready) {
+      sp_data = rob_entry.result;
+    } else {
+      sp_rsid = RST_[rob_index];
+    }
+  }
+
   // allocat new ROB entry and obtain its index
   // TODO:
  int rob_Allocation = ROB_.allocate(instr);
@@ -125,13 +146,23 @@ void Core::issue() {
   if(rs_index < 0){
     return; // If RS_.issue returns a negative index, we know that something must have gone wrong
   }
+  RS_.get_entry(rs_index).sp_index = sp_rsid;
+  RS_.get_entry(rs_index).sp_data = sp_data;
 
   // update RST mapping
   // TODO:
   // Set the RST_ to now point to the reservation station that will execute the instruction
   RST_[rob_Allocation] = rs_index;
+  instr->timing().issue = perf_stats_.cycles;
+
+  branch_issued_ = (instr->getBrOp() != BrOp::NONE);
 
   DT(2, "Issue: " << *instr);
+  OBSERVE(observer_, ISSUE, on_issue(instr->getId(), instr->getPC(), *instr));
+  BT(tracer_, perf_stats_.cycles, Issue, Stage, instr->getId(), instr->getPC(), rs_index, rob_Allocation);
+  if (konata_) {
+    konata_->stage(perf_stats_.cycles, instr->getId(), "I");
+  }
 
   // pop issue queue
   issue_queue_->pop();
@@ -141,6 +172,11 @@ void Core::execute() {
   // execute functional units
   for (auto fu : FUs_) {
     fu->execute();
+    if (konata_ && fu->done()) {
+      // result ready, waiting for the CDB
+      auto& rob_entry = ROB_.get_entry(fu->get_output().rob_index);
+      konata_->stage(perf_stats_.cycles, rob_entry.instr->getId(), "C");
+    }
   }
 
   // find the next functional units that is done executing
@@ -148,13 +184,23 @@ void Core::execute() {
   // then clear the functional unit.
   // The CDB can only serve one functional unit per cycle
   // HINT: should use CDB_ and FUs_
+  bool cdb_granted = false;
   for (auto fu : FUs_) {
     // TODO:
     if(fu->done()){
+      if (cdb_granted) {
+        // lost the CDB arbitration this cycle
+        ++hpm_events_[VX_HPM_EVENT_CDB_CONFLICT];
+        continue;
+      }
       auto cdb_data = fu->get_output();
       CDB_.push(cdb_data.result, cdb_data.rob_index, cdb_data.rs_index);
+      if (tracer_) {
+        auto& cdb_instr = *ROB_.get_entry(cdb_data.rob_index).instr;
+        BT(tracer_, perf_stats_.cycles, Execute, Stage, cdb_instr.getId(), cdb_instr.getPC(), (int)cdb_instr.getFUType(), cdb_data.result);
+      }
       fu->clear();
-      break;
+      cdb_granted = true;
     }
   }
 
@@ -167,12 +213,19 @@ void Core::execute() {
     auto& entry = RS_.get_entry(rs_index);
     // TODO:
     if(entry.valid && !entry.running && entry.operands_ready() && !RS_.locked(rs_index)){
+      // CSR accesses are serialized: they only leave the ROB head
+      if (!IDEAL_MCYCLE && entry.instr->getExeFlags().is_csr && entry.rob_index != ROB_.head_index())
+        continue;
       //Determine which FU is necessary
       FUType fu_type = entry.instr->getFUType();
       auto fu = FUs_.at(static_cast<int>(fu_type));
       if(!fu->busy()){
         fu->issue(entry.instr, entry.rob_index, rs_index, entry.rs1_data, entry.rs2_data);
         entry.running = true;
+        entry.instr->timing().dispatch = perf_stats_.cycles;
+        if (konata_) {
+          konata_->stage(perf_stats_.cycles, entry.instr->getId(), "X");
+        }
         // Only one instruction per cycle(not superscalar)
         //break;
       }
@@ -205,21 +258,46 @@ void Core::writeback() {
   // update ROB
   // TODO:
   ROB_.update(cdb_data);
+  ROB_.get_entry(cdb_data.rob_index).instr->timing().complete = perf_stats_.cycles;
+  if (tracer_) {
+    auto& wb_instr = *ROB_.get_entry(cdb_data.rob_index).instr;
+    BT(tracer_, perf_stats_.cycles, Writeback, Stage, wb_instr.getId(), wb_instr.getPC(), cdb_data.rob_index, cdb_data.result);
+  }
+  if (konata_) {
+    konata_->stage(perf_stats_.cycles, ROB_.get_entry(cdb_data.rob_index).instr->getId(), "W");
+  }
 
   // clear CDB
   // TODO:
   CDB_.pop(); // Remove the current data from the CDB
 
-  RS_.dump();
+  if (tracer_) {
+    RS_.dump(tracer_, perf_stats_.cycles);
+  }
 }
 
 void Core::commit() {
   // commit ROB head entry
-  if (ROB_.empty())
+  if (ROB_.empty()) {
+    ++perf_stats_.stalls[(int)this->commit_stall_cause()];
+    if (pc_profile_) {
+      pc_profile_->stall(this->oldest_PC());
+    }
     return;
+  }
 
   int head_index = ROB_.head_index();
   auto& rob_head = ROB_.get_entry(head_index);
+  if (!rob_head.ready) {
+    auto cause = this->commit_stall_cause();
+    ++perf_stats_.stalls[(int)cause];
+    if (cause == StallCause::Lsu) {
+      ++mem_stall_cycles_;
+    }
+    if (pc_profile_) {
+      pc_profile_->stall(rob_head.instr->getPC());
+    }
+  }
 
   // check if the head entry is ready to commit
   if (rob_head.ready) {
@@ -248,9 +326,35 @@ void Core::commit() {
     ROB_.pop(); // Get rid of the head entry(and commit)
 
     DT(2, "Commit: " << *instr);
+    OBSERVE(observer_, COMMIT, on_commit(instr->getId(), instr->getPC(), *instr));
+    BT(tracer_, perf_stats_.cycles, Commit, Stage, instr->getId(), instr->getPC(), head_index, rob_head.result);
+    if (konata_) {
+      konata_->retire(perf_stats_.cycles, instr->getId());
+    }
+
+    latency_.record(*instr, perf_stats_.cycles);
+    instr_mix_.commit(*instr);
+    if (pc_profile_) {
+      pc_profile_->commit(instr->getPC(), instr);
+    }
+    if (call_profile_) {
+      call_profile_->commit(instr->getPC(), *instr);
+    }
+    if (mem_profile_) {
+      auto it = mem_regions_.find(instr->getId());
+      if (it != mem_regions_.end()) {
+        mem_profile_->stall(it->second, mem_stall_cycles_);
+        mem_regions_.erase(it);
+      }
+    }
+    if (pattern_profile_ && (exe_flags.is_load || exe_flags.is_store)) {
+      pattern_profile_->stall(instr->getPC(), mem_stall_cycles_);
+    }
+    mem_stall_cycles_ = 0;
 
     assert(perf_stats_.instrs <= fetched_instrs_);
     ++perf_stats_.instrs;
+    last_commit_cycle_ = perf_stats_.cycles;
 
     // handle program termination
     if (exe_flags.is_exit) {
@@ -258,5 +362,181 @@ void Core::commit() {
     }
   }
 
-  ROB_.dump();
-}
\ No newline at end of file
+  if (tracer_) {
+    ROB_.dump(tracer_, perf_stats_.cycles);
+  }
+}
+
+StallCause Core::commit_stall_cause() const {
+  if (ROB_.empty()) {
+    // nothing younger than a branch is fetched until the BRU resolves it
+    return branch_issued_ ? StallCause::Branch : StallCause::Frontend;
+  }
+
+  int head_index = ROB_.head_index();
+  for (auto fu : FUs_) {
+    if (fu->done() && fu->get_output().rob_index == head_index)
+      return StallCause::Cdb;
+  }
+
+  if (!issue_queue_->empty()) {
+    if (ROB_.full())
+      return StallCause::RobFull;
+    if (RS_.full())
+      return StallCause::RsFull;
+  }
+
+  switch (ROB_.get_entry(head_index).instr->getFUType()) {
+  case FUType::BRU: return StallCause::Bru;
+  case FUType::LSU: return StallCause::Lsu;
+  case FUType::SFU: return StallCause::Sfu;
+  default:          return StallCause::Alu;
+  }
+}
+
+void Core::sample_occupancy() {
+  uint32_t busy_fus = 0;
+  for (auto fu : FUs_) {
+    busy_fus += fu->busy();
+  }
+
+  // the structure closest to commit that is holding back the front-end
+  auto limiter = Limiter::None;
+  if (!issue_queue_->empty() && ROB_.full()) {
+    limiter = Limiter::ROB;
+  } else if (!issue_queue_->empty() && RS_.full()) {
+    limiter = Limiter::RS;
+  } else if (issue_queue_->full() && !decode_queue_->empty()) {
+    limiter = Limiter::ISQ;
+  } else if (decode_queue_->full() && !fetch_stalled_->read()) {
+    limiter = Limiter::IDQ;
+  }
+
+  occupancy_.sample({ROB_.count(), RS_.count(), decode_queue_->size(), issue_queue_->size(), busy_fus, limiter});
+
+  if (OCCUPANCY_INTERVAL != 0
+   && ((perf_stats_.cycles + 1) % OCCUPANCY_INTERVAL) == 0) {
+    occupancy_.dump_interval(std::cout, perf_stats_.cycles + 1);
+  }
+}
+
+uint32_t Core::oldest_PC() {
+  // oldest instruction not yet in the ROB
+  if (!issue_queue_->empty())
+    return issue_queue_->data().instr->getPC();
+  if (!decode_queue_->empty())
+    return decode_queue_->data().PC;
+  return PC_;
+}
+
+void Core::watchdog_report(std::ostream& os) const {
+  os << std::dec << "*** Watchdog: no commit for " << (perf_stats_.cycles - last_commit_cycle_)
+     << " cycles (cycle=" << perf_stats_.cycles << ", instrs=" << perf_stats_.instrs << ")" << std::endl;
+
+  // ROB from head to tail
+  os << "ROB: " << ROB_.count() << "/" << ROB_SIZE << ", head=" << ROB_.head_index() << std::endl;
+  for (uint32_t i = 0; i < ROB_.count(); ++i) {
+    int index = (ROB_.head_index() + i) % ROB_SIZE;
+    auto& entry = ROB_.get_entry(index);
+    os << "  rob[" << index << "] ready=" << entry.ready << ": " << *entry.instr << std::endl;
+  }
+
+  os << "RS: " << RS_.count() << "/" << RS_.size() << std::endl;
+  for (uint32_t i = 0; i < RS_.size(); ++i) {
+    auto& entry = RS_.get_entry(i);
+    if (!entry.valid)
+      continue;
+    os << "  rs[" << i << "] #" << entry.instr->getId() << " rob=" << entry.rob_index << " running=" << entry.running
+       << " rs1=" << entry.rs1_index << " rs2=" << entry.rs2_index << " locked=" << RS_.locked(i) << std::endl;
+  }
+
+  os << "FU:";
+  for (int i = 0; i < (int)FUs_.size(); ++i) {
+    auto& fu = FUs_.at(i);
+    os << " " << (FUType)i << "=";
+    if (!fu->busy()) {
+      os << "idle";
+    } else {
+      os << (fu->done() ? "done" : "busy") << "(rob " << fu->get_output().rob_index << ")";
+    }
+  }
+  os << std::endl;
+
+  os << "CDB: ";
+  if (CDB_.empty()) {
+    os << "empty";
+  } else {
+    os << "rob " << CDB_.data().rob_index << ", rs " << CDB_.data().rs_index;
+  }
+  os << ", issue queue=" << (issue_queue_->empty() ? "empty" : "pending")
+     << ", decode queue=" << (decode_queue_->empty() ? "empty" : "pending")
+     << ", fetch stalled=" << fetch_stalled_->read() << std::endl;
+
+  // follow the dependencies that hold back the ROB head
+  os << "Blocking chain:";
+  if (ROB_.empty()) {
+    os << " ROB empty, front-end " << (fetch_stalled_->read() ? "stalled on an unresolved branch" : "not delivering") << std::endl;
+    return;
+  }
+  std::set<int> visited;
+  int rob_index = ROB_.head_index();
+  for (;;) {
+    auto& rob_entry = ROB_.get_entry(rob_index);
+    os << " #" << rob_entry.instr->getId() << " (rob " << rob_index << ")";
+    if (!visited.insert(rob_index).second) {
+      os << " closes a cycle";
+      break;
+    }
+    if (rob_entry.ready) {
+      os << " is complete but not retired";
+      break;
+    }
+    int rs_index = -1;
+    for (uint32_t i = 0; i < RS_.size(); ++i) {
+      auto& entry = RS_.get_entry(i);
+      if (entry.valid && entry.rob_index == rob_index) {
+        rs_index = i;
+        break;
+      }
+    }
+    if (rs_index == -1) {
+      os << " is neither complete nor in a reservation station";
+      break;
+    }
+    auto& rs_entry = RS_.get_entry(rs_index);
+    auto& fu = FUs_.at((int)rs_entry.instr->getFUType());
+    if (rs_entry.running) {
+      if (!fu->busy() || fu->get_output().rob_index != rob_index) {
+        os << " is marked running in rs[" << rs_index << "] but no " << rs_entry.instr->getFUType() << " holds it";
+      } else if (fu->done()) {
+        os << " has a result waiting for the CDB";
+      } else {
+        os << " is executing on the " << rs_entry.instr->getFUType();
+      }
+      break;
+    }
+    if (RS_.locked(rs_index)) {
+      os << " waits on the LSU ordering barrier (ticket " << rs_entry.barrier_id << ")";
+      break;
+    }
+    if (!rs_entry.operands_ready()) {
+      int producer = (rs_entry.rs1_index != -1) ? rs_entry.rs1_index : rs_entry.rs2_index;
+      auto& producer_entry = RS_.get_entry(producer);
+      os << " waits on rs[" << producer << "] ->";
+      if (!producer_entry.valid) {
+        os << " which is free (lost wakeup)";
+        break;
+      }
+      rob_index = producer_entry.rob_index;
+      continue;
+    }
+    if (fu->busy()) {
+      os << " waits for the " << rs_entry.instr->getFUType() << " ->";
+      rob_index = fu->get_output().rob_index;
+      continue;
+    }
+    os << " is ready to dispatch";
+    break;
+  }
+  os << std::endl;
+}
@@ -0,0 +1,74 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <ostream>
+#include <unordered_map>
+
+namespace tinyrv {
+
+enum class AccessPattern {
+  Constant,  // same address every time
+  Strided,   // constant non-zero address delta
+  Chase,     // address derived from the value this PC loaded last
+  Irregular, // none of the above dominates
+  Count
+};
+
+// Per-PC effective address pattern classifier for loads and stores.
+// Every dynamic access is compared with the previous one of the same PC;
+// a PC takes the pattern that explains at least half of its transitions.
+// Memory stall cycles charged to each PC show how much latency a
+// prefetcher matching its pattern could hide. The per-PC report is written
+// when the profiler is destroyed.
+class PatternProfiler {
+public:
+  PatternProfiler(const char* filename);
+
+  ~PatternProfiler();
+
+  void access(uint32_t PC, uint32_t addr, uint32_t value, bool is_load);
+
+  // charges memory stall cycles to the access at PC
+  void stall(uint32_t PC, uint64_t cycles);
+
+  void report(std::ostream& os) const;
+
+  void print_summary(std::ostream& os) const;
+
+private:
+
+  struct pc_stats_t {
+    uint64_t accesses;
+    uint64_t hits[(int)AccessPattern::Count];
+    uint64_t stall_cycles;
+    uint32_t last_addr;
+    uint32_t last_value;
+    int32_t  last_delta;
+    int32_t  stride;       // majority-vote candidate among repeated deltas
+    uint64_t stride_votes;
+    bool     is_load;
+  };
+
+  static AccessPattern classify(const pc_stats_t& stats);
+
+  std::string filename_;
+  std::unordered_map<uint32_t, pc_stats_t> pcs_;
+  uint64_t accesses_;
+  uint64_t stall_cycles_;
+};
+
+}
@@ -0,0 +1,96 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include "pcprof.h"
+#include "instr.h"
+
+using namespace tinyrv;
+
+PCProfiler::PCProfiler(const char* filename)
+  : filename_(filename)
+  , cycles_(0)
+  , instrs_(0)
+{}
+
+PCProfiler::~PCProfiler() {
+  std::ofstream ofs(filename_);
+  if (!ofs) {
+    std::cout << "Error: cannot open profile file " << filename_ << std::endl;
+    return;
+  }
+  this->report(ofs);
+}
+
+void PCProfiler::commit(uint32_t PC, const std::shared_ptr<Instr>& instr) {
+  auto& stats = pcs_[PC];
+  ++stats.cycles;
+  ++stats.execs;
+  auto exe_flags = instr->getExeFlags();
+  if (exe_flags.is_load || exe_flags.is_store) {
+    ++stats.mem_ops;
+  }
+  if (!stats.instr) {
+    stats.instr = instr;
+  }
+  ++cycles_;
+  ++instrs_;
+}
+
+void PCProfiler::stall(uint32_t PC) {
+  auto& stats = pcs_[PC];
+  ++stats.cycles;
+  ++stats.stalls;
+  ++cycles_;
+}
+
+void PCProfiler::mispredict(uint32_t PC) {
+  ++pcs_[PC].mispredicts;
+}
+
+void PCProfiler::report(std::ostream& os) const {
+  // hottest PCs first
+  std::vector<std::pair<uint32_t, const pc_stats_t*>> order;
+  for (auto& it : pcs_) {
+    order.push_back({it.first, &it.second});
+  }
+  std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+    return (a.second->cycles != b.second->cycles) ? (a.second->cycles > b.second->cycles) : (a.first < b.first);
+  });
+
+  os << "# cycles=" << cycles_ << ", instrs=" << instrs_ << std::endl;
+  os << "#" << std::setw(11) << "cycles" << std::setw(9) << "%"
+     << std::setw(12) << "stalls" << std::setw(12) << "execs"
+     << std::setw(10) << "mispred" << std::setw(10) << "memops"
+     << "  PC          instruction" << std::endl;
+  for (auto& it : order) {
+    auto& stats = *it.second;
+    double percent = cycles_ ? (100.0 * stats.cycles / cycles_) : 0.0;
+    os << std::dec << std::setw(12) << stats.cycles
+       << std::setw(8) << std::fixed << std::setprecision(2) << percent << "%" << std::defaultfloat
+       << std::setw(12) << stats.stalls << std::setw(12) << stats.execs
+       << std::setw(10) << stats.mispredicts << std::setw(10) << stats.mem_ops
+       << "  0x" << std::hex << std::setw(8) << std::setfill('0') << it.first << std::setfill(' ') << std::dec
+       << "  ";
+    if (stats.instr) {
+      print_asm(os, *stats.instr);
+    } else {
+      os << "<not committed>";
+    }
+    os << std::dec << std::endl;
+  }
+}
@@ -0,0 +1,63 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+
+namespace tinyrv {
+
+class Instr;
+
+// Per-PC cycle attribution of the guest program.
+// Every simulated cycle is charged to exactly one PC: the committing
+// instruction, or the oldest instruction holding up commit. The annotated
+// report is written when the profiler is destroyed.
+class PCProfiler {
+public:
+  PCProfiler(const char* filename);
+
+  ~PCProfiler();
+
+  // charges a committing cycle to the instruction
+  void commit(uint32_t PC, const std::shared_ptr<Instr>& instr);
+
+  // charges a cycle without commit to the PC holding up the pipeline
+  void stall(uint32_t PC);
+
+  void mispredict(uint32_t PC);
+
+  void report(std::ostream& os) const;
+
+private:
+
+  struct pc_stats_t {
+    uint64_t cycles;
+    uint64_t stalls;
+    uint64_t execs;
+    uint64_t mispredicts;
+    uint64_t mem_ops;
+    std::shared_ptr<Instr> instr;
+  };
+
+  std::string filename_;
+  std::unordered_map<uint32_t, pc_stats_t> pcs_;
+  uint64_t cycles_;
+  uint64_t instrs_;
+};
+
+}
@@ -16,7 +16,8 @@
 
 using namespace tinyrv;
 
-ProcessorImpl::ProcessorImpl() {
+ProcessorImpl::ProcessorImpl()
+  : started_(false) {
   // initialize simulator
   SimPlatform::instance().initialize();
 
@@ -35,26 +36,140 @@ void ProcessorImpl::reset() {
   core_->reset();
 }
 
-void ProcessorImpl::attach_ram(RAM* ram) {
+void ProcessorImpl::attach_ram(MemDevice* ram) {
   core_->attach_ram(ram);
 }
 
 int ProcessorImpl::run(bool riscv_test) {
   SimPlatform::instance().reset();
   this->reset();
+  started_ = false;
+
+  if (host_profile_) {
+    host_profile_->start(core_->perf_stats().instrs, core_->perf_stats().cycles);
+  }
 
   bool done;
   Word exitcode = 0;
   do {
-    SimPlatform::instance().tick();
+    HOST_PROFILE(Platform, SimPlatform::instance().tick());
     done = core_->check_exit(&exitcode, riscv_test);
   } while (!done);
 
+  if (host_profile_) {
+    host_profile_->stop(core_->perf_stats().instrs, core_->perf_stats().cycles);
+  }
+
+  return exitcode;
+}
+
+void ProcessorImpl::reset_to_image() {
+  // only the pages written by the last run need restoring
+  core_->restore_dirty_pages();
+  this->reset();
+  started_ = false;
+}
+
+bool ProcessorImpl::run_for(uint64_t cycles) {
+  if (!started_) {
+    SimPlatform::instance().reset();
+    this->reset();
+    started_ = true;
+  }
+
+  if (host_profile_) {
+    host_profile_->start(core_->perf_stats().instrs, core_->perf_stats().cycles);
+  }
+
+  bool done = false;
+  Word exitcode;
+  for (uint64_t i = 0; i < cycles && !done; ++i) {
+    HOST_PROFILE(Platform, SimPlatform::instance().tick());
+    done = core_->check_exit(&exitcode, false);
+  }
+
+  if (host_profile_) {
+    host_profile_->stop(core_->perf_stats().instrs, core_->perf_stats().cycles);
+  }
+
+  if (done) {
+    started_ = false;
+  }
+  return done;
+}
+
+bool ProcessorImpl::step() {
+  return this->run_for(1);
+}
+
+int ProcessorImpl::exitcode(bool riscv_test) const {
+  Word exitcode = 0;
+  core_->check_exit(&exitcode, riscv_test);
   return exitcode;
 }
 
+void ProcessorImpl::set_observer(CoreObserver* observer) {
+  core_->set_observer(observer);
+}
+
+void ProcessorImpl::enable_trace(const char* filename) {
+  tracer_ = std::make_shared<TraceWriter>(filename, 0);
+  core_->attach_tracer(tracer_.get());
+}
+
+void ProcessorImpl::enable_konata(const char* filename, uint64_t begin_cycle, uint64_t end_cycle) {
+  konata_ = std::make_shared<KonataWriter>(filename, begin_cycle, end_cycle);
+  core_->attach_konata(konata_.get());
+}
+
+void ProcessorImpl::enable_pc_profile(const char* filename) {
+  pc_profile_ = std::make_shared<PCProfiler>(filename);
+  core_->attach_pc_profile(pc_profile_.get());
+}
+
+void ProcessorImpl::enable_call_profile(const char* filename, const char* symfile) {
+  call_profile_ = std::make_shared<CallProfiler>(filename, symfile);
+  core_->attach_call_profile(call_profile_.get());
+}
+
+void ProcessorImpl::enable_interval_stats(const char* filename, uint64_t period, bool by_instrs) {
+  interval_ = std::make_shared<IntervalWriter>(filename, period, by_instrs);
+  core_->attach_interval(interval_.get());
+}
+
+void ProcessorImpl::enable_host_profile() {
+  host_profile_ = std::make_shared<HostProfiler>();
+}
+
+void ProcessorImpl::enable_stat_page(const char* filename, uint64_t period) {
+  stat_page_ = std::make_shared<StatPage>(filename, period);
+  core_->attach_stat_page(stat_page_.get());
+}
+
+void ProcessorImpl::enable_mem_profile(const char* symfile) {
+  mem_profile_ = std::make_shared<MemProfiler>(symfile);
+  core_->attach_mem_profile(mem_profile_.get());
+}
+
+void ProcessorImpl::enable_pattern_profile(const char* filename) {
+  pattern_profile_ = std::make_shared<PatternProfiler>(filename);
+  core_->attach_pattern_profile(pattern_profile_.get());
+}
+
 void ProcessorImpl::showStats() {
   core_->showStats();
+  if (call_profile_) {
+    call_profile_->print_summary(std::cout);
+  }
+  if (mem_profile_) {
+    mem_profile_->print(std::cout);
+  }
+  if (pattern_profile_) {
+    pattern_profile_->print_summary(std::cout);
+  }
+  if (host_profile_) {
+    host_profile_->print(std::cout);
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -67,7 +182,7 @@ Processor::~Processor() {
   delete impl_;
 }
 
-void Processor::attach_ram(RAM* mem) {
+void Processor::attach_ram(MemDevice* mem) {
   impl_->attach_ram(mem);
 }
 
@@ -75,6 +190,62 @@ int Processor::run(bool riscv_test) {
   return impl_->run(riscv_test);
 }
 
+void Processor::reset_to_image() {
+  impl_->reset_to_image();
+}
+
+bool Processor::run_for(uint64_t cycles) {
+  return impl_->run_for(cycles);
+}
+
+bool Processor::step() {
+  return impl_->step();
+}
+
+int Processor::exitcode(bool riscv_test) const {
+  return impl_->exitcode(riscv_test);
+}
+
+void Processor::set_observer(CoreObserver* observer) {
+  impl_->set_observer(observer);
+}
+
+void Processor::enable_trace(const char* filename) {
+  impl_->enable_trace(filename);
+}
+
+void Processor::enable_konata(const char* filename, uint64_t begin_cycle, uint64_t end_cycle) {
+  impl_->enable_konata(filename, begin_cycle, end_cycle);
+}
+
+void Processor::enable_pc_profile(const char* filename) {
+  impl_->enable_pc_profile(filename);
+}
+
+void Processor::enable_call_profile(const char* filename, const char* symfile) {
+  impl_->enable_call_profile(filename, symfile);
+}
+
+void Processor::enable_interval_stats(const char* filename, uint64_t period, bool by_instrs) {
+  impl_->enable_interval_stats(filename, period, by_instrs);
+}
+
+void Processor::enable_host_profile() {
+  impl_->enable_host_profile();
+}
+
+void Processor::enable_stat_page(const char* filename, uint64_t period) {
+  impl_->enable_stat_page(filename, period);
+}
+
+void Processor::enable_mem_profile(const char* symfile) {
+  impl_->enable_mem_profile(symfile);
+}
+
+void Processor::enable_pattern_profile(const char* filename) {
+  impl_->enable_pattern_profile(filename);
+}
+
 void Processor::showStats() {
   impl_->showStats();
 }
\ No newline at end of file
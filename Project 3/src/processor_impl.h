@@ -23,16 +23,54 @@ public:
   ProcessorImpl();
   ~ProcessorImpl();
 
-  void attach_ram(RAM* mem);
+  void attach_ram(MemDevice* mem);
 
   int run(bool riscv_test);
 
+  void reset_to_image();
+
+  bool run_for(uint64_t cycles);
+
+  bool step();
+
+  int exitcode(bool riscv_test) const;
+
+  void set_observer(CoreObserver* observer);
+
+  void enable_trace(const char* filename);
+
+  void enable_konata(const char* filename, uint64_t begin_cycle, uint64_t end_cycle);
+
+  void enable_pc_profile(const char* filename);
+
+  void enable_call_profile(const char* filename, const char* symfile);
+
+  void enable_interval_stats(const char* filename, uint64_t period, bool by_instrs);
+
+  void enable_host_profile();
+
+  void enable_stat_page(const char* filename, uint64_t period);
+
+  void enable_mem_profile(const char* symfile);
+
+  void enable_pattern_profile(const char* filename);
+
   void showStats();
 
 private:
   void reset();
 
   Core::Ptr core_;
+  bool started_;
+  std::shared_ptr<TraceWriter> tracer_;
+  std::shared_ptr<KonataWriter> konata_;
+  std::shared_ptr<PCProfiler> pc_profile_;
+  std::shared_ptr<CallProfiler> call_profile_;
+  std::shared_ptr<IntervalWriter> interval_;
+  std::shared_ptr<HostProfiler> host_profile_;
+  std::shared_ptr<StatPage> stat_page_;
+  std::shared_ptr<MemProfiler> mem_profile_;
+  std::shared_ptr<PatternProfiler> pattern_profile_;
 };
 
 }
@@ -0,0 +1,67 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+// Live statistics page.
+// The core publishes its counters every few thousand cycles into a
+// memory-mapped file that external viewers (Tools/src/tinyrv-top.cpp) map
+// read-only. Updates are plain stores guarded by a sequence counter
+// (seqlock): the writer makes seq odd, stores the values and makes it even
+// again; a reader retries until it sees the same even seq before and after
+// its copy. Publishing never blocks on, or issues a syscall for, a reader.
+
+namespace tinyrv {
+
+#define STATPAGE_MAGIC    0x54565350 // "TVSP"
+#define STATPAGE_VERSION  1
+#define STATPAGE_COUNTERS 120
+#define STATPAGE_NAME     24
+
+struct StatPageData {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t seq;     // odd while an update is in progress
+  uint32_t count;   // number of published counters
+  uint64_t updates; // number of completed updates
+  char     names[STATPAGE_COUNTERS][STATPAGE_NAME];
+  uint64_t values[STATPAGE_COUNTERS];
+};
+
+class StatPage {
+public:
+  StatPage(const char* filename, uint64_t period);
+
+  ~StatPage();
+
+  // is an update due at the given cycle?
+  bool due(uint64_t cycle) const {
+    return cycle >= next_cycle_;
+  }
+
+  void begin(uint64_t cycle);
+
+  void field(const char* key, uint64_t value);
+
+  void end();
+
+private:
+  StatPageData* data_;
+  uint64_t period_;
+  uint64_t next_cycle_;
+  uint32_t fields_;
+};
+
+}
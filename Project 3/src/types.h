@@ -187,6 +187,11 @@ public:
 
   uint32_t tock() { return tock_++; }
 
+  void reset() {
+    tick_ = 0;
+    tock_ = 0;
+  }
+
 private:
   uint32_t tick_;
   uint32_t tock_;
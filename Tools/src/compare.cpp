@@ -0,0 +1,263 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Cross-model comparison driver.
+// Runs the same program through the Project 1, 2 and 3 simulators in
+// parallel and reports their performance counters side by side.
+// Each model is a separate binary (the cores share class names), so the
+// driver launches them as child processes and parses their "PERF" lines.
+// Lines of the form "PERF[<region>]: ..." are reported per region.
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+struct model_t {
+  std::string name;
+  std::string command;
+  int exitcode;
+  // region -> ordered (key, value) counters
+  std::map<std::string, std::vector<std::pair<std::string, std::string>>> regions;
+};
+
+static void show_usage() {
+   std::cout << "Usage: [-1 <cmd>: in-order core] [-2 <cmd>: gshare core] [-3 <cmd>: tomasulo core] [-h: help] <program>" << std::endl;
+}
+
+static std::vector<model_t> models = {
+  {"inorder",  "./tinyrv1",    -1, {}},
+  {"gshare",   "./tinyrv2 -g", -1, {}},
+  {"tomasulo", "./tinyrv3",    -1, {}},
+};
+static const char* program = nullptr;
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "1:2:3:h?")) != -1) {
+    switch (c) {
+    case '1':
+    case '2':
+    case '3':
+      models.at(c - '1').command = optarg;
+      break;
+    case 'h':
+    case '?':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+
+  if (optind < argc) {
+    program = argv[optind];
+  } else {
+    show_usage();
+    exit(-1);
+  }
+}
+
+static void parse_perf_line(model_t& model, const std::string& line) {
+  // PERF[<region>]: key=value, key=value, ...
+  std::string region = "total";
+  auto colon = line.find(':');
+  if (colon == std::string::npos)
+    return;
+  auto lbr = line.find('[');
+  if (lbr != std::string::npos && lbr < colon) {
+    region = line.substr(lbr + 1, line.find(']', lbr) - lbr - 1);
+  }
+  auto& counters = model.regions[region];
+  std::stringstream ss(line.substr(colon + 1));
+  std::string token;
+  while (std::getline(ss, token, ',')) {
+    auto eq = token.find('=');
+    if (eq == std::string::npos)
+      continue;
+    auto key = token.substr(0, eq);
+    key.erase(0, key.find_first_not_of(' '));
+    auto value = token.substr(eq + 1);
+    // bpred=<hits>/<branches> is reported as an accuracy
+    auto slash = value.find('/');
+    if (slash != std::string::npos) {
+      double hits = atof(value.substr(0, slash).c_str());
+      double total = atof(value.substr(slash + 1).c_str());
+      counters.push_back({key + "_branches", value.substr(slash + 1)});
+      std::stringstream acc;
+      acc << std::fixed << std::setprecision(4) << (total ? (hits / total) : 0.0);
+      value = acc.str();
+      key += "_accuracy";
+    }
+    counters.push_back({key, value});
+  }
+}
+
+// single-quotes a word for /bin/sh, so paths with spaces or shell
+// metacharacters reach the simulator unchanged
+static std::string shell_quote(const std::string& word) {
+  std::string quoted("'");
+  for (auto c : word) {
+    if (c == '\'') {
+      quoted += "'\\''";
+    } else {
+      quoted += c;
+    }
+  }
+  return quoted + "'";
+}
+
+static void run_model(model_t* model) {
+  // the model command is a shell command line, the program is a single argument
+  auto command = model->command + " -s " + shell_quote(program) + " 2>&1";
+  auto pipe = popen(command.c_str(), "r");
+  if (pipe == nullptr) {
+    std::cout << "*** error: cannot run " << command << std::endl;
+    return;
+  }
+  char buffer[4096];
+  while (fgets(buffer, sizeof(buffer), pipe)) {
+    std::string line(buffer);
+    line.erase(line.find_last_not_of(" \r\n") + 1);
+    if (line.compare(0, 4, "PERF") == 0) {
+      parse_perf_line(*model, line);
+    }
+  }
+  int status = pclose(pipe);
+  model->exitcode = WIFEXITED(status) ? (int8_t)WEXITSTATUS(status) : -1;
+}
+
+static const std::string* find_counter(const model_t& model, const std::string& region, const std::string& key) {
+  auto it = model.regions.find(region);
+  if (it == model.regions.end())
+    return nullptr;
+  for (auto& counter : it->second) {
+    if (counter.first == key)
+      return &counter.second;
+  }
+  return nullptr;
+}
+
+static void add_cpi(model_t& model) {
+  for (auto& region : model.regions) {
+    auto cycles = find_counter(model, region.first, "cycles");
+    auto instrs = find_counter(model, region.first, "instrs");
+    if (cycles == nullptr || instrs == nullptr)
+      continue;
+    double n = atof(instrs->c_str());
+    std::stringstream cpi;
+    cpi << std::fixed << std::setprecision(4) << (n ? (atof(cycles->c_str()) / n) : 0.0);
+    region.second.insert(region.second.begin(), {"CPI", cpi.str()});
+  }
+}
+
+static void show_report() {
+  const int width = 16;
+
+  std::cout << std::left << std::setw(24) << "model";
+  for (auto& model : models) {
+    std::cout << std::setw(width) << model.name;
+  }
+  for (uint32_t i = 1; i < models.size(); ++i) {
+    std::cout << std::setw(width) << ("d(" + models[i].name + ")");
+  }
+  std::cout << std::endl;
+
+  std::cout << std::setw(24) << "exitcode";
+  for (auto& model : models) {
+    std::cout << std::setw(width) << model.exitcode;
+  }
+  std::cout << std::endl;
+
+  // collect the union of regions and counters, in first-seen order
+  std::vector<std::string> regions;
+  for (auto& model : models) {
+    for (auto& region : model.regions) {
+      if (std::find(regions.begin(), regions.end(), region.first) == regions.end()) {
+        regions.push_back(region.first);
+      }
+    }
+  }
+
+  for (auto& region : regions) {
+    std::vector<std::string> keys;
+    for (auto& model : models) {
+      auto it = model.regions.find(region);
+      if (it == model.regions.end())
+        continue;
+      for (auto& counter : it->second) {
+        if (std::find(keys.begin(), keys.end(), counter.first) == keys.end()) {
+          keys.push_back(counter.first);
+        }
+      }
+    }
+
+    std::cout << "[" << region << "]" << std::endl;
+    for (auto& key : keys) {
+      std::cout << std::setw(24) << ("  " + key);
+      for (auto& model : models) {
+        auto value = find_counter(model, region, key);
+        std::cout << std::setw(width) << (value ? *value : "-");
+      }
+      // deltas relative to the in-order core
+      auto base = find_counter(models[0], region, key);
+      for (uint32_t i = 1; i < models.size(); ++i) {
+        auto value = find_counter(models[i], region, key);
+        if (base && value) {
+          std::stringstream delta;
+          delta << std::showpos << std::setprecision(6) << (atof(value->c_str()) - atof(base->c_str()));
+          std::cout << std::setw(width) << delta.str();
+        } else {
+          std::cout << std::setw(width) << "-";
+        }
+      }
+      std::cout << std::endl;
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  parse_args(argc, argv);
+
+  std::cout << "Comparing " << program << ".." << std::endl;
+
+  std::vector<std::thread> threads;
+  for (auto& model : models) {
+    threads.emplace_back(run_model, &model);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (auto& model : models) {
+    add_cpi(model);
+  }
+
+  show_report();
+
+  for (auto& model : models) {
+    if (model.exitcode != 0)
+      return model.exitcode;
+  }
+  return 0;
+}
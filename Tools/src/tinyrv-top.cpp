@@ -0,0 +1,165 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Live viewer for the simulator statistics page (see statpage.h).
+// Shows each counter with its rate per host second and per simulated cycle,
+// so stall counters read as CPI fractions and occupancy sums as averages.
+// Build with the include path of any of the project sources, e.g.
+//   g++ -I"Project 3/src" Tools/src/tinyrv-top.cpp -o tinyrv-top
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "statpage.h"
+
+using namespace tinyrv;
+
+static void show_usage() {
+   std::cout << "Usage: [-d <ms>: refresh delay] [-n <count>: refreshes, 0 = until exit] [-h: help] <page>" << std::endl;
+}
+
+static uint32_t delay_ms = 1000;
+static uint32_t num_refreshes = 0;
+static const char* page_file = nullptr;
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "d:n:h?")) != -1) {
+    switch (c) {
+    case 'd':
+      delay_ms = atoi(optarg);
+      break;
+    case 'n':
+      num_refreshes = atoi(optarg);
+      break;
+    case 'h':
+    case '?':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+
+  if (optind < argc) {
+    page_file = argv[optind];
+  } else {
+    show_usage();
+    exit(-1);
+  }
+}
+
+struct snapshot_t {
+  uint64_t updates;
+  std::vector<std::string> names;
+  std::vector<uint64_t> values;
+};
+
+// seqlock read: retry until the copy was not overlapped by an update
+static void read_snapshot(const StatPageData* data, snapshot_t* snapshot) {
+  for (;;) {
+    auto seq = __atomic_load_n(&data->seq, __ATOMIC_ACQUIRE);
+    if (seq & 0x1) {
+      std::this_thread::yield();
+      continue;
+    }
+    uint32_t count = std::min<uint32_t>(data->count, STATPAGE_COUNTERS);
+    snapshot->updates = data->updates;
+    snapshot->names.resize(count);
+    snapshot->values.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      snapshot->names[i].assign(data->names[i], strnlen(data->names[i], STATPAGE_NAME));
+      snapshot->values[i] = data->values[i];
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&data->seq, __ATOMIC_RELAXED) == seq)
+      return;
+  }
+}
+
+static uint64_t lookup(const snapshot_t& snapshot, const char* name) {
+  for (size_t i = 0; i < snapshot.names.size(); ++i) {
+    if (snapshot.names[i] == name)
+      return snapshot.values[i];
+  }
+  return 0;
+}
+
+static void render(std::ostream& os, const snapshot_t& cur, const snapshot_t& prev, double seconds) {
+  uint64_t cycles = lookup(cur, "cycles") - lookup(prev, "cycles");
+  os << "\033[H\033[2J";
+  os << "tinyrv-top: " << page_file << ", updates=" << cur.updates
+     << (lookup(cur, "exited") ? " (exited)" : "")
+     << (lookup(cur, "wedged") ? " (wedged)" : "") << std::endl << std::endl;
+  os << std::left << std::setw(STATPAGE_NAME) << "counter" << std::right
+     << std::setw(16) << "value" << std::setw(16) << "per second" << std::setw(12) << "per cycle" << std::endl;
+  for (size_t i = 0; i < cur.names.size(); ++i) {
+    uint64_t delta = cur.values[i] - ((i < prev.values.size()) ? prev.values[i] : 0);
+    os << std::left << std::setw(STATPAGE_NAME) << cur.names[i] << std::right
+       << std::setw(16) << cur.values[i]
+       << std::setw(16) << uint64_t(seconds > 0 ? (delta / seconds) : 0)
+       << std::setw(12) << std::fixed << std::setprecision(3) << (cycles ? (double(delta) / cycles) : 0.0)
+       << std::defaultfloat << std::endl;
+  }
+}
+
+int main(int argc, char **argv) {
+  parse_args(argc, argv);
+
+  int fd = open(page_file, O_RDONLY);
+  if (fd < 0) {
+    std::cout << "*** error: cannot open " << page_file << std::endl;
+    return -1;
+  }
+  auto addr = mmap(nullptr, sizeof(StatPageData), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    std::cout << "*** error: cannot map " << page_file << std::endl;
+    return -1;
+  }
+  auto data = (const StatPageData*)addr;
+  if (__atomic_load_n(&data->magic, __ATOMIC_ACQUIRE) != STATPAGE_MAGIC
+   || data->version != STATPAGE_VERSION) {
+    std::cout << "*** error: " << page_file << " is not a compatible stats page" << std::endl;
+    munmap(addr, sizeof(StatPageData));
+    return -1;
+  }
+
+  snapshot_t prev, cur;
+  read_snapshot(data, &prev);
+  auto prev_time = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; num_refreshes == 0 || n < num_refreshes; ++n) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+    read_snapshot(data, &cur);
+    auto now = std::chrono::steady_clock::now();
+    render(std::cout, cur, prev, std::chrono::duration<double>(now - prev_time).count());
+    // the Tomasulo core also stops when its watchdog fires
+    if (lookup(cur, "exited") || lookup(cur, "wedged"))
+      break;
+    prev = cur;
+    prev_time = now;
+  }
+
+  munmap(addr, sizeof(StatPageData));
+  return 0;
+}
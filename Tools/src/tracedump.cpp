@@ -0,0 +1,174 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Offline decoder for binary pipeline traces (see bintrace.h).
+// Renders each record in the same text format as the DT() debug trace,
+// disassembling Decode records with the simulator's own decoder.
+// Build against the sources of the project that wrote the trace, e.g.
+//   g++ -I"Project 3/src" -I<simulator common headers> \
+//     Tools/src/tracedump.cpp "Project 3/src/decode.cpp" -o tracedump
+
+#include <iostream>
+#include <iomanip>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "bintrace.h"
+#include "instr.h"
+
+using namespace tinyrv;
+
+static void show_usage() {
+   std::cout << "Usage: [-b <cycle>: begin] [-e <cycle>: end] [-h: help] <trace>" << std::endl;
+}
+
+static uint64_t begin_cycle = 0;
+static uint64_t end_cycle = UINT64_MAX;
+static const char* trace_file = nullptr;
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "b:e:h?")) != -1) {
+    switch (c) {
+    case 'b':
+      begin_cycle = strtoull(optarg, nullptr, 0);
+      break;
+    case 'e':
+      end_cycle = strtoull(optarg, nullptr, 0);
+      break;
+    case 'h':
+    case '?':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+
+  if (optind < argc) {
+    trace_file = argv[optind];
+  } else {
+    show_usage();
+    exit(-1);
+  }
+}
+
+static const char* stage_name(TraceStage stage) {
+  switch (stage) {
+  case TraceStage::Fetch:     return "Fetch";
+  case TraceStage::Decode:    return "Decode";
+  case TraceStage::Issue:     return "Issue";
+  case TraceStage::Execute:   return "Execute";
+  case TraceStage::Memory:    return "Memory";
+  case TraceStage::Writeback: return "Writeback";
+  case TraceStage::Commit:    return "Commit";
+  default:                    return "?";
+  }
+}
+
+static void render(std::ostream& os, const TraceRecord& rec) {
+  os << "DEBUG " << std::dec << std::setw(10) << rec.cycle << ": ";
+  uint32_t addr = rec.payload & 0xffffffff;
+  uint32_t data = rec.payload >> 32;
+  switch (rec.event) {
+  case TraceEvent::Stage:
+    switch (rec.stage) {
+    case TraceStage::Fetch:
+      os << "Fetch: instr=0x" << std::hex << rec.payload << ", PC=0x" << rec.PC;
+      break;
+    case TraceStage::Decode: {
+      auto instr = decode_instr(rec.payload);
+      if (instr) {
+        os << "Decode: ";
+        print_asm(os, *instr);
+      } else {
+        os << "Decode: instr=0x" << std::hex << rec.payload;
+      }
+      os << ", PC=0x" << std::hex << rec.PC;
+    } break;
+    case TraceStage::Issue:
+      os << "Issue: rob=" << rec.payload << ", rs=" << rec.aux << ", PC=0x" << std::hex << rec.PC;
+      break;
+    default:
+      os << stage_name(rec.stage) << ": result=0x" << std::hex << rec.payload << ", PC=0x" << rec.PC;
+      break;
+    }
+    break;
+  case TraceEvent::Stall:
+    os << "*** " << stage_name(rec.stage) << " Stall: reason=" << rec.aux;
+    break;
+  case TraceEvent::Flush:
+    os << "*** Branch misprediction: next_PC=0x" << std::hex << rec.payload;
+    break;
+  case TraceEvent::Branch:
+    os << "Branch: " << ((rec.aux & 0x1) ? "taken" : "not-taken")
+       << ((rec.aux & 0x2) ? " (mispredicted)" : "")
+       << ", target=0x" << std::hex << rec.payload;
+    break;
+  case TraceEvent::MemRead:
+    os << "Mem Read: addr=0x" << std::hex << addr << ", data=0x" << data << std::dec << " (size=" << rec.aux << ")";
+    break;
+  case TraceEvent::MemWrite:
+    os << "Mem Write: addr=0x" << std::hex << addr << ", data=0x" << data << std::dec << " (size=" << rec.aux << ")";
+    break;
+  case TraceEvent::RSState:
+    os << "RS[" << rec.aux << "] rob=" << (int8_t)(rec.payload & 0xff)
+       << ", running=" << ((rec.payload >> 8) & 0x1)
+       << ", rs1=" << (int)(int8_t)((rec.payload >> 16) & 0xff)
+       << ", rs2=" << (int)(int8_t)((rec.payload >> 24) & 0xff);
+    break;
+  case TraceEvent::ROBState:
+    os << "ROB[" << rec.aux << "] ready=" << (rec.payload & 0x1) << ", head=" << ((rec.payload >> 1) & 0x1);
+    break;
+  default:
+    os << "unknown event " << (int)rec.event;
+    break;
+  }
+  os << std::dec << " (#" << rec.uuid << ")" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  parse_args(argc, argv);
+
+  auto file = fopen(trace_file, "rb");
+  if (file == nullptr) {
+    std::cout << "*** error: cannot open " << trace_file << std::endl;
+    return -1;
+  }
+
+  TraceFileHeader header;
+  if (fread(&header, sizeof(header), 1, file) != 1
+   || header.magic != TRACE_MAGIC
+   || header.version != TRACE_VERSION
+   || header.record_size != sizeof(TraceRecord)) {
+    std::cout << "*** error: " << trace_file << " is not a compatible trace file" << std::endl;
+    fclose(file);
+    return -1;
+  }
+
+  TraceRecord records[1024];
+  size_t count;
+  while ((count = fread(records, sizeof(TraceRecord), 1024, file)) != 0) {
+    for (size_t i = 0; i < count; ++i) {
+      auto& rec = records[i];
+      if (rec.cycle < begin_cycle || rec.cycle > end_cycle)
+        continue;
+      render(std::cout, rec);
+    }
+  }
+
+  fclose(file);
+  return 0;
+}